@@ -21,20 +21,31 @@ void NormalizeProbabilities(std::vector<double>& probabilities)
 }
 
 Alias Alias::CreateDistribution(std::vector<double> probabilities, util::Random& rng)
+{
+	auto result = CreateDistribution(std::move(probabilities));
+	result.m_random = &rng;
+	return result;
+}
+
+Alias Alias::CreateDistribution(std::vector<double> probabilities)
 {
 	assert(probabilities.size() > 0);
 	if (probabilities.size() <= 0) {
 		throw EmptyProbabilityException();
 	}
 	NormalizeProbabilities(probabilities);
-	std::size_t n = probabilities.size();
+	const std::size_t n = probabilities.size();
 	std::vector<double> prob(n);
 	std::vector<std::size_t> alias(n);
-	std::vector<std::size_t> small, large;
-	for (auto& i : probabilities) {
-		i *= n;
-	}
-	for (std::size_t i = 0; i < probabilities.size(); i++) {
+
+	// Worklists of the indices of the columns that are under-full (small) and over-full (large); each
+	// step fills up one small column from a large one, so every column is handled once.
+	std::vector<std::size_t> small;
+	std::vector<std::size_t> large;
+	small.reserve(n);
+	large.reserve(n);
+	for (std::size_t i = 0; i < n; i++) {
+		probabilities[i] *= n;
 		if (probabilities[i] < 1.0) {
 			small.push_back(i);
 		} else {
@@ -42,41 +53,32 @@ Alias Alias::CreateDistribution(std::vector<double> probabilities, util::Random&
 		}
 	}
 
-	while (!(small.empty() || large.empty())) {
-		std::size_t l = large.front();
-		large.erase(large.begin());
-		std::size_t g = small.front();
-		small.erase(small.begin());
+	while (!small.empty() && !large.empty()) {
+		const std::size_t l = small.back();
+		small.pop_back();
+		const std::size_t g = large.back();
+		large.pop_back();
 		prob[l] = probabilities[l];
 		alias[l] = g;
 
-		probabilities[g] = probabilities[g] + probabilities[l] - 1;
-		if (probabilities[g] >= 1) {
-			large.push_back(g);
-		} else {
+		probabilities[g] = (probabilities[g] + probabilities[l]) - 1.0;
+		if (probabilities[g] < 1.0) {
 			small.push_back(g);
+		} else {
+			large.push_back(g);
 		}
 	}
 
+	// What is left are full columns, up to rounding.
 	for (auto g : large) {
-		prob[g] = 1;
+		prob[g] = 1.0;
+		alias[g] = g;
 	}
-
 	for (auto l : small) {
-		prob[l] = 1;
-	}
-	return Alias(std::move(alias), std::move(prob), rng);
-}
-
-std::size_t Alias::Next()
-{
-	std::size_t roll = (*m_random)(m_alias.size());
-	double flip = m_random->NextDouble();
-	if (flip <= m_prob[roll]) {
-		return roll;
-	} else {
-		return m_alias[roll];
+		prob[l] = 1.0;
+		alias[l] = l;
 	}
+	return Alias(std::move(alias), std::move(prob), nullptr);
 }
 
 } // end-of-namespace
@@ -1,6 +1,8 @@
 #ifndef ALIAS_H_INCLUDED
 #define ALIAS_H_INCLUDED
 
+#include <algorithm>
+#include <cstddef>
 #include <unordered_map>
 #include <vector>
 #include "util/Random.h"
@@ -30,13 +32,38 @@ public:
 	/// Creates an Alias object.
 	static Alias CreateDistribution(std::vector<double> probabilities, util::Random& rng);
 
+	/// Creates an Alias object without a random number generator; it can only be sampled with Next(rng).
+	static Alias CreateDistribution(std::vector<double> probabilities);
+
 	/// Generates a new number.
-	std::size_t Next();
+	std::size_t Next() { return Next(*m_random); }
+
+	/// Generates a new number with the given random number generator instead of the one of this Alias.
+	std::size_t Next(util::Random& rng) const
+	{
+		// A single draw picks the column with its integer part and decides between the column and
+		// its alias with its fraction.
+		const double roll = rng.NextDouble() * static_cast<double>(m_prob.size());
+		const std::size_t column = std::min(static_cast<std::size_t>(roll), m_prob.size() - 1);
+		return roll - static_cast<double>(column) < m_prob[column] ? column : m_alias[column];
+	}
+
+	/// Appends count new numbers to the given values.
+	void NextN(std::size_t count, std::vector<std::size_t>& values) { NextN(*m_random, count, values); }
+
+	/// Appends count new numbers, generated with the given random number generator, to the given values.
+	void NextN(util::Random& rng, std::size_t count, std::vector<std::size_t>& values) const
+	{
+		values.reserve(values.size() + count);
+		for (std::size_t i = 0; i < count; i++) {
+			values.push_back(Next(rng));
+		}
+	}
 
 private:
 	/// Constructor
-	Alias(std::vector<std::size_t>&& alias, std::vector<double>&& prob, util::Random& rng)
-	    : m_random(&rng), m_alias(std::move(alias)), m_prob(std::move(prob))
+	Alias(std::vector<std::size_t>&& alias, std::vector<double>&& prob, util::Random* rng)
+	    : m_random(rng), m_alias(std::move(alias)), m_prob(std::move(prob))
 	{
 	}
 
@@ -81,6 +108,18 @@ public:
 	/// Generates a new value.
 	T Next() { return value_map[inner_alias.Next()]; }
 
+	/// Generates a new value with the given random number generator.
+	T Next(util::Random& rng) const { return value_map[inner_alias.Next(rng)]; }
+
+	/// Appends count new values to the given values.
+	void NextN(std::size_t count, std::vector<T>& values)
+	{
+		values.reserve(values.size() + count);
+		for (std::size_t i = 0; i < count; i++) {
+			values.push_back(Next());
+		}
+	}
+
 private:
 	BiasedRandomValueGenerator(Alias&& inner_alias, std::vector<T>&& value_map)
 	    : inner_alias(std::move(inner_alias)), value_map(std::move(value_map))
@@ -11,23 +11,23 @@
 namespace stride {
 
 template <typename BehaviourPolicy, typename BeliefPolicy>
-void ThresholdData::Contact(std::shared_ptr<const GenericPersonData<BehaviourPolicy, BeliefPolicy>> p)
+void ThresholdData::Contact(const GenericPerson<BehaviourPolicy, BeliefPolicy>& p)
 {
 	m_num_contacts++;
-	if (p->GetHealth().IsSymptomatic()) {
+	if (p.GetHealth().IsSymptomatic()) {
 		m_num_contacts_infected++;
 	}
-	const auto other_belief_data = p->GetBeliefData();
+	const auto other_belief_data = p.GetBeliefData();
 	if (BeliefPolicy::HasAdopted(other_belief_data)) {
 		m_num_contacts_adopted++;
 	}
 }
 
 template void ThresholdData::Contact<AlwaysFollowBeliefs, Threshold<true, false>>(
-    std::shared_ptr<const GenericPersonData<AlwaysFollowBeliefs, Threshold<true, false>>> p);
+    const GenericPerson<AlwaysFollowBeliefs, Threshold<true, false>>& p);
 template void ThresholdData::Contact<AlwaysFollowBeliefs, Threshold<false, true>>(
-    std::shared_ptr<const GenericPersonData<AlwaysFollowBeliefs, Threshold<false, true>>> p);
+    const GenericPerson<AlwaysFollowBeliefs, Threshold<false, true>>& p);
 template void ThresholdData::Contact<AlwaysFollowBeliefs, Threshold<true, true>>(
-    std::shared_ptr<const GenericPersonData<AlwaysFollowBeliefs, Threshold<true, true>>> p);
+    const GenericPerson<AlwaysFollowBeliefs, Threshold<true, true>>& p);
 
 } /* namespace stride */
@@ -17,7 +17,7 @@
 namespace stride {
 
 template <typename BehaviourPolicy, typename BeliefPolicy>
-class GenericPersonData;
+class GenericPerson;
 
 /*
  * p(behaviour) = OR0 * (OR1^x1 * OR2^x2 * OR3^x3 * OR4^x4)/ (1 + OR0 * (prod ORi^xi))
@@ -28,10 +28,10 @@ class HBM
 public:
 	using Data = HBMData;
 
-	static void Update(Data& belief_data, Health& health_data) {}
+	static void Update(Data& belief_data, const Health& health_data) {}
 
 	template <typename BehaviourPolicy>
-	static void Update(Data& belief_data, const GenericPersonData<BehaviourPolicy, HBM>* p)
+	static void Update(Data& belief_data, const GenericPerson<BehaviourPolicy, HBM>& p)
 	{
 	}
 
@@ -6,7 +6,7 @@
 namespace stride {
 
 template <typename BehaviourPolicy, typename BeliefPolicy>
-class GenericPersonData;
+class GenericPerson;
 
 class NoBelief
 {
@@ -15,10 +15,10 @@ public:
 
 	static void Initialize(Data& belief_data, double risk_averseness) {}
 
-	static void Update(Data& belief_data, Health& health_data) {}
+	static void Update(Data& belief_data, const Health& health_data) {}
 
 	template <typename BehaviourPolicy>
-	static void Update(Data& belief_data, std::shared_ptr<const GenericPersonData<BehaviourPolicy, NoBelief>> p)
+	static void Update(Data& belief_data, const GenericPerson<BehaviourPolicy, NoBelief>& p)
 	{
 	}
 
@@ -13,9 +13,9 @@
 
 namespace stride {
 
-/// Forward declaration of class GenericPersonData
+/// Forward declaration of class GenericPerson
 template <typename BehaviourPolicy, typename BeliefPolicy>
-class GenericPersonData;
+class GenericPerson;
 
 template <bool threshold_infected, bool threshold_adopted>
 class Threshold
@@ -33,13 +33,12 @@ public:
 		}
 	}
 
-	static void Update(Data& belief_data, Health& health_data) {}
+	static void Update(Data& belief_data, const Health& health_data) {}
 
 	template <typename BehaviourPolicy>
 	static void Update(
 	    Data& belief_data,
-	    std::shared_ptr<const GenericPersonData<BehaviourPolicy, Threshold<threshold_infected, threshold_adopted>>>
-		p)
+	    const GenericPerson<BehaviourPolicy, Threshold<threshold_infected, threshold_adopted>>& p)
 	{
 		belief_data.Contact<BehaviourPolicy, Threshold<threshold_infected, threshold_adopted>>(p);
 	}
@@ -66,6 +65,6 @@ extern template class Threshold<true, false>;
 extern template class Threshold<false, true>;
 extern template class Threshold<true, true>;
 
-#endif /* SRC_MAIN_CPP_BEHAVIOUR_BELIEF_POLICIES_THRESHOLD_H_ */
-
 } /* namespace stride */
+
+#endif /* SRC_MAIN_CPP_BEHAVIOUR_BELIEF_POLICIES_THRESHOLD_H_ */
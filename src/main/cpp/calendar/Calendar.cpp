@@ -3,6 +3,7 @@
 #include "util/Errors.h"
 #include "util/InstallDirs.h"
 
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
@@ -56,6 +57,10 @@ void Calendar::Initialize(const boost::gregorian::date& start_date, const boost:
 			m_school_holidays.push_back(new_holiday);
 		}
 	}
+
+	// Keep the holidays sorted for lookup.
+	sort(m_holidays.begin(), m_holidays.end());
+	sort(m_school_holidays.begin(), m_school_holidays.end());
 }
 
 } // end_of_namespace
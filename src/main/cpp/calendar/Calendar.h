@@ -41,13 +41,12 @@ public:
 	std::size_t GetYear() const { return m_date.year(); }
 
 	/// Check if it's a holiday
-	bool IsHoliday() const { return (std::find(m_holidays.begin(), m_holidays.end(), m_date) != m_holidays.end()); }
+	bool IsHoliday() const { return std::binary_search(m_holidays.begin(), m_holidays.end(), m_date); }
 
 	/// Check if it's a school holiday
 	bool IsSchoolHoliday() const
 	{
-		return (
-		    std::find(m_school_holidays.begin(), m_school_holidays.end(), m_date) != m_school_holidays.end());
+		return std::binary_search(m_school_holidays.begin(), m_school_holidays.end(), m_date);
 	}
 
 	/// Check if it's the weekend
@@ -66,10 +65,10 @@ private:
 	/// The current simulated day
 	boost::gregorian::date m_date;
 
-	/// Vector of general holidays
+	/// Sorted vector of general holidays
 	std::vector<boost::gregorian::date> m_holidays;
 
-	/// Vector of school holidays
+	/// Sorted vector of school holidays
 	std::vector<boost::gregorian::date> m_school_holidays;
 };
 
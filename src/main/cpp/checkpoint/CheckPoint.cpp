@@ -404,15 +404,17 @@ void CheckPoint::LoadCheckPoint(boost::gregorian::date date, Simulator& sim)
 			toAdd.ParticipateInSurvey();
 		}
 
+		Health health(disease);
 		if (data.Immune) {
-			toAdd.GetHealth().SetImmune();
+			health.SetImmune();
 		}
 		if (data.Infected) {
-			toAdd.GetHealth().StartInfection();
+			health.StartInfection();
 		}
 		for (unsigned int i = 0; i < data.TimeInfected; i++) {
-			toAdd.GetHealth().Update();
+			health.Update();
 		}
+		toAdd.SetHealth(health);
 
 		result->emplace(toAdd);
 		H5Sclose(subspace);
@@ -866,15 +868,17 @@ multiregion::ExpatriateJournal CheckPoint::LoadExpatriates(const Population& pop
 			toAdd.ParticipateInSurvey();
 		}
 
+		Health health(disease);
 		if (p.Immune) {
-			toAdd.GetHealth().SetImmune();
+			health.SetImmune();
 		}
 		if (p.Infected) {
-			toAdd.GetHealth().StartInfection();
+			health.StartInfection();
 		}
 		for (unsigned int i = 0; i < p.TimeInfected; i++) {
-			toAdd.GetHealth().Update();
+			health.Update();
 		}
+		toAdd.SetHealth(health);
 		result.AddExpatriate(toAdd);
 	}
 	return result;
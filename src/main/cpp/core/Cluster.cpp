@@ -5,7 +5,10 @@
 #include "calendar/Calendar.h"
 #include "pop/Person.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <limits>
 #include <memory>
 #include <vector>
 #include <spdlog/spdlog.h>
@@ -17,7 +20,8 @@ using namespace std;
 std::array<ContactProfile, NumOfClusterTypes()> Cluster::g_profiles;
 
 Cluster::Cluster(std::size_t cluster_id, ClusterType cluster_type)
-    : m_cluster_id(cluster_id), m_cluster_type(cluster_type), m_index_immune(0),
+    : m_cluster_id(cluster_id), m_cluster_type(cluster_type), m_num_cases(0), m_index_immune(0), m_num_infectious(0),
+      m_store(nullptr), m_probabilities(nullptr), m_presence_key(numeric_limits<uint32_t>::max()),
       m_profile(g_profiles.at(ToSizeType(m_cluster_type)))
 {
 }
@@ -29,80 +33,151 @@ void Cluster::AddContactProfile(ClusterType cluster_type, const ContactProfile&
 
 void Cluster::AddPerson(const Person& p)
 {
-	if (p.GetHealth().IsImmune()) {
-		m_members.emplace_back(std::make_pair(p, p.IsInCluster(m_cluster_type)));
-	} else {
-		m_members.emplace(m_members.begin() + m_index_immune, std::make_pair(p, p.IsInCluster(m_cluster_type)));
-		m_index_immune++;
+	assert((m_store == nullptr || m_store == p.GetStore()) && "Cluster::AddPerson: members from different stores");
+	m_store = p.GetStore();
+	const auto health = p.GetHealth();
+	if (health.IsInfectious()) {
+		UpdateInfectiousCount(true);
 	}
+	m_members.emplace_back(p.GetIndex());
+	m_member_present.emplace_back(p.IsInCluster(m_cluster_type));
+	MoveFromBack(health.GetHealthStatus());
+	m_presence_key = numeric_limits<uint32_t>::max();
+	m_probabilities = nullptr;
 }
 
 void Cluster::RemovePerson(const Person& p)
 {
-	std::size_t index = 0;
-	while (index < m_members.size()) {
-		if (m_members[index].first == p) {
-			m_members.erase(m_members.begin() + index);
-			if (m_index_immune == index) {
-				m_index_immune++;
-			}
-			if (m_index_immune > m_members.size()) {
-				m_index_immune = m_members.size();
-			}
-			return;
-		}
-		index++;
+	const auto position = FindMember(p.GetIndex(), p.GetHealth().GetHealthStatus());
+	if (position == m_members.size()) {
+		return;
+	}
+	if (p.GetHealth().IsInfectious()) {
+		UpdateInfectiousCount(false);
 	}
+	MoveToBack(position);
+	m_members.pop_back();
+	m_member_present.pop_back();
+	m_probabilities = nullptr;
 }
 
-tuple<bool, std::size_t> Cluster::SortMembers()
+void Cluster::UpdateMemberStatus(PersonIndex index)
 {
-	bool infectious_cases = false;
-	std::size_t num_cases = 0;
-
-	for (size_t i_member = 0; i_member < m_index_immune; i_member++) {
-		// if immune, move to back
-		if (m_members[i_member].first.GetHealth().IsImmune()) {
-			bool swapped = false;
-			std::size_t new_place = m_index_immune - 1;
-			m_index_immune--;
-			while (!swapped && new_place > i_member) {
-				if (m_members[new_place].first.GetHealth().IsImmune()) {
-					m_index_immune--;
-					new_place--;
-				} else {
-					swap(m_members[i_member], m_members[new_place]);
-					swapped = true;
-				}
-			}
-		}
-		// else, if not susceptible, move to front
-		else if (!m_members[i_member].first.GetHealth().IsSusceptible()) {
-			if (!infectious_cases && m_members[i_member].first.GetHealth().IsInfectious()) {
-				infectious_cases = true;
-			}
-			if (i_member > num_cases) {
-				swap(m_members[i_member], m_members[num_cases]);
-			}
-			num_cases++;
-		}
+	// Only susceptible members change partition: they are infected or become immune.
+	const auto position = FindMember(index, HealthStatus::Susceptible);
+	if (position == m_members.size()) {
+		return;
+	}
+	const auto status = m_store->GetHealthStatus(index);
+	const bool is_case = position < m_num_cases;
+	const bool is_immune = position >= m_index_immune;
+	if (IsImmune(status) == is_immune && IsSusceptible(status) == (!is_case && !is_immune)) {
+		return;
+	}
+	MoveToBack(position);
+	MoveFromBack(status);
+}
+
+void Cluster::FirstTouch()
+{
+	std::vector<PersonIndex>(m_members).swap(m_members);
+	std::vector<bool>(m_member_present).swap(m_member_present);
+}
+
+std::size_t Cluster::FindMember(PersonIndex index, HealthStatus status) const
+{
+	std::size_t first = 0U;
+	std::size_t last = m_num_cases;
+	if (IsSusceptible(status)) {
+		first = m_num_cases;
+		last = m_index_immune;
+	} else if (IsImmune(status)) {
+		first = m_index_immune;
+		last = m_members.size();
+	}
+	const auto begin = m_members.begin();
+	const auto position = find(begin + first, begin + last, index);
+	if (position != begin + last) {
+		return static_cast<std::size_t>(position - begin);
+	}
+	const auto before = find(begin, begin + first, index);
+	if (before != begin + first) {
+		return static_cast<std::size_t>(before - begin);
+	}
+	return static_cast<std::size_t>(find(begin + last, m_members.end(), index) - begin);
+}
+
+void Cluster::MoveToBack(std::size_t position)
+{
+	// Every partition boundary the member crosses takes one swap.
+	if (position < m_num_cases) {
+		m_num_cases--;
+		SwapMembers(position, m_num_cases);
+		position = m_num_cases;
+	}
+	if (position < m_index_immune) {
+		m_index_immune--;
+		SwapMembers(position, m_index_immune);
+		position = m_index_immune;
+	}
+	SwapMembers(position, m_members.size() - 1);
+}
+
+void Cluster::MoveFromBack(HealthStatus status)
+{
+	if (IsImmune(status)) {
+		return;
+	}
+	SwapMembers(m_members.size() - 1, m_index_immune);
+	if (!IsSusceptible(status)) {
+		SwapMembers(m_index_immune, m_num_cases);
+		m_num_cases++;
+	}
+	m_index_immune++;
+}
+
+void Cluster::UpdateInfectiousCount(bool is_infectious)
+{
+	if (is_infectious) {
+		m_num_infectious++;
+	} else {
+		assert(m_num_infectious > 0 && "Cluster::UpdateInfectiousCount: no infectious members");
+		m_num_infectious--;
 	}
+}
 
-	return make_tuple(infectious_cases, num_cases);
+void Cluster::SwapMembers(std::size_t i, std::size_t j)
+{
+	swap(m_members[i], m_members[j]);
+	vector<bool>::swap(m_member_present[i], m_member_present[j]);
 }
 
 void Cluster::UpdateMemberPresence()
 {
-	for (auto& member : m_members) {
-		member.second = member.first.IsInCluster(m_cluster_type);
+	// Presence only depends on the type of day and on whether a member is a child, so it is
+	// only recomputed when either the type of day or the members change.
+	if (m_store == nullptr || m_store->GetPresenceKey() == m_presence_key) {
+		return;
+	}
+	m_presence_key = m_store->GetPresenceKey();
+
+	const bool adults_present = m_store->IsPresentToday(false, m_cluster_type);
+	const bool children_present = m_store->IsPresentToday(true, m_cluster_type);
+	if (adults_present == children_present) {
+		m_member_present.assign(m_members.size(), adults_present);
+	} else {
+		for (std::size_t i = 0; i < m_members.size(); i++) {
+			m_member_present[i] = m_store->IsChild(m_members[i]) ? children_present : adults_present;
+		}
 	}
 }
 
 std::vector<Person> Cluster::GetPeople() const
 {
 	std::vector<Person> result;
-	for (auto& i : m_members) {
-		result.push_back(i.first);
+	result.reserve(m_members.size());
+	for (auto index : m_members) {
+		result.emplace_back(m_store, index);
 	}
 	return result;
 }
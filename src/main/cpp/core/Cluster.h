@@ -3,12 +3,16 @@
 
 #include "behaviour/information_policies/NoLocalInformation.h"
 #include "core/ClusterType.h"
+#include "core/ContactProbabilities.h"
 #include "core/ContactProfile.h"
+#include "core/Health.h"
 #include "core/LogMode.h"
 #include "pop/Person.h"
 
 #include <array>
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 //#include <memory>
 
@@ -34,6 +38,14 @@ public:
 	/// Removes the given person from this cluster.
 	void RemovePerson(const Person& p);
 
+	/// Moves the member with the given index to the members with the same health status, after
+	/// its health status changed; this takes a linear search and a few swaps.
+	void UpdateMemberStatus(PersonIndex index);
+
+	/// Moves the member data to fresh memory that is written first by the calling thread, so that it
+	/// ends up on the NUMA node of that thread.
+	void FirstTouch();
+
 	/// Returns the ID of the cluster.
 	ClusterId GetId() const { return m_cluster_id; }
 
@@ -46,19 +58,59 @@ public:
 	/// Return the type of this cluster.
 	ClusterType GetClusterType() const { return m_cluster_type; }
 
+	/// Return number of infectious persons in this cluster.
+	std::size_t GetInfectiousCount() const { return m_num_infectious; }
+
+	/// Return number of susceptible persons in this cluster.
+	std::size_t GetSusceptibleCount() const { return m_index_immune - m_num_cases; }
+
+	/// Record that a member of this cluster became infectious or stopped being infectious.
+	void UpdateInfectiousCount(bool is_infectious);
+
 	/// Get basic contact rate in this cluster.
 	double GetContactRate(const Person& p) const
 	{
 		return g_profiles.at(ToSizeType(m_cluster_type))[EffectiveAge(p.GetAge())] / m_members.size();
 	}
 
+	/// Look up the contact probabilities for the current size of this cluster in the given table. This
+	/// has to be done after members were added or removed and before the Infector visits the cluster.
+	void UpdateContactProbabilities(ContactProbabilityTable& table)
+	{
+		m_probabilities = &table.Get(m_cluster_type, m_members.size(), m_profile);
+	}
+
+	/// Get the contact probabilities for the current size of this cluster.
+	const ContactProbabilities& GetContactProbabilities() const
+	{
+		assert(m_probabilities != nullptr && "Cluster::GetContactProbabilities: not looked up");
+		return *m_probabilities;
+	}
+
+	/// Get the effective age of the person at the given index of the person store.
+	unsigned int GetEffectiveAge(PersonIndex index) const
+	{
+		return EffectiveAge(static_cast<unsigned int>(m_store->GetAge(index)));
+	}
+
 public:
 	/// Add contact profile.
 	static void AddContactProfile(ClusterType cluster_type, const ContactProfile& profile);
 
 private:
-	/// Sort members w.r.t. health status (order: exposed/infected/recovered, susceptible, immune).
-	std::tuple<bool, std::size_t> SortMembers();
+	/// Get the position of the member with the given index, or the size if there is no such member.
+	/// The partition of the given health status, where the member is expected, is searched first.
+	std::size_t FindMember(PersonIndex index, HealthStatus status) const;
+
+	/// Moves the member at the given position to the last position; the other members stay in
+	/// their partition.
+	void MoveToBack(std::size_t position);
+
+	/// Moves the member at the last position to the partition of the given health status.
+	void MoveFromBack(HealthStatus status);
+
+	/// Swap the members at the given positions.
+	void SwapMembers(std::size_t i, std::size_t j);
 
 	/// Infector calculates contacts and transmissions.
 	template <LogMode log_level, bool track_index_case, typename local_information_policy>
@@ -74,11 +126,31 @@ private:
 	/// The type of the Cluster (for logging purposes).
 	ClusterType m_cluster_type;
 
+	/// The members are partitioned by health status: the cases (exposed, infected or recovered),
+	/// the susceptible members and the immune members. Index of the first susceptible member.
+	std::size_t m_num_cases;
+
 	/// Index of the first immune member in the Cluster.
 	std::size_t m_index_immune;
 
-	/// Container with pointers to Cluster members.
-	std::vector<std::pair<Person, bool>> m_members;
+	/// Number of infectious members in the Cluster.
+	std::size_t m_num_infectious;
+
+	/// The person store that holds the data of the Cluster members.
+	PersonStore* m_store;
+
+	/// The contact probabilities for the size of the Cluster.
+	const ContactProbabilities* m_probabilities;
+
+	/// Indices of the Cluster members in the person store.
+	std::vector<PersonIndex> m_members;
+
+	/// Presence of the Cluster members today, parallel to m_members.
+	std::vector<bool> m_member_present;
+
+	/// Presence key of the person store (i.e. the type of day) m_member_present was computed
+	/// for; a value outside the range of keys when it has to be recomputed.
+	std::uint32_t m_presence_key;
 
 	const ContactProfile& m_profile;
 
@@ -0,0 +1,44 @@
+#include "ContactProbabilities.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace stride {
+
+using namespace std;
+
+ContactProbabilityTable::ContactProbabilityTable() : m_transmission_rate(0.0), m_probabilities() {}
+
+void ContactProbabilityTable::SetTransmissionRate(double transmission_rate)
+{
+	if (transmission_rate != m_transmission_rate) {
+		m_transmission_rate = transmission_rate;
+		for (auto& probabilities : m_probabilities) {
+			probabilities.clear();
+		}
+	}
+}
+
+const ContactProbabilities& ContactProbabilityTable::Get(
+    ClusterType cluster_type, std::size_t size, const ContactProfile& profile)
+{
+	auto& probabilities = m_probabilities[ToSizeType(cluster_type)];
+	if (size >= probabilities.size()) {
+		probabilities.resize(size + 1);
+	}
+	auto& result = probabilities[size];
+	if (!result) {
+		// Empty clusters have no contacts; avoid dividing by zero all the same.
+		const double num_members = max<size_t>(size, 1U);
+		result = make_unique<ContactProbabilities>();
+		for (unsigned int age = 0; age <= MaximumAge(); age++) {
+			const double contact_rate = profile[age] / num_members;
+			result->contact[age] = 1 - exp(-contact_rate);
+			result->contact_and_transmission[age] = 1 - exp(-m_transmission_rate * contact_rate);
+		}
+		result->transmission = 1 - exp(-m_transmission_rate);
+	}
+	return *result;
+}
+
+} // namespace stride
@@ -0,0 +1,58 @@
+#ifndef CONTACT_PROBABILITIES_H_INCLUDED
+#define CONTACT_PROBABILITIES_H_INCLUDED
+
+#include "core/ClusterType.h"
+#include "core/ContactProfile.h"
+#include "pop/Age.h"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace stride {
+
+/**
+ * Ready-to-compare probabilities for the members of clusters of one type and size, per effective age.
+ */
+struct ContactProbabilities
+{
+	/// Probability of a contact with one other member.
+	std::array<double, MaximumAge() + 1> contact;
+
+	/// Probability of a contact with one other member that transmits the disease.
+	std::array<double, MaximumAge() + 1> contact_and_transmission;
+
+	/// Probability that a contact transmits the disease.
+	double transmission;
+};
+
+/**
+ * The contact probabilities of every cluster type and size that is in use. A contact rate only
+ * depends on the cluster type, the size of the cluster and the age of a member, so clusters of
+ * the same type and size share their probabilities.
+ */
+class ContactProbabilityTable
+{
+public:
+	/// Creates an empty table.
+	ContactProbabilityTable();
+
+	/// Sets the transmission rate; all probabilities are recomputed if it changes.
+	void SetTransmissionRate(double transmission_rate);
+
+	/// Get the probabilities for clusters of the given type and size with the given contact profile,
+	/// which are computed the first time. This is not thread-safe.
+	const ContactProbabilities& Get(ClusterType cluster_type, std::size_t size, const ContactProfile& profile);
+
+private:
+	/// The transmission rate the probabilities were computed for.
+	double m_transmission_rate;
+
+	/// Per cluster type, the probabilities by cluster size, null if not computed yet.
+	std::array<std::vector<std::unique_ptr<ContactProbabilities>>, NumOfClusterTypes()> m_probabilities;
+};
+
+} // namespace stride
+
+#endif // end-of-include-guard
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include "Disease.h"
+#include "util/Parallel.h"
 
 namespace stride {
 namespace disease {
@@ -8,17 +11,23 @@ using util::Random;
 using boost::property_tree::ptree;
 using boost::property_tree::ptree_error;
 
-unsigned int Distribution::Sample(Random& rng) const
+std::shared_ptr<const alias::Alias> Distribution::CreateAlias(const std::vector<double>& p)
 {
-	const double random_value = rng.NextDouble();
-	for (unsigned int i = 0; i < probabilities.size(); i++) {
-		if (random_value <= probabilities[i]) {
-			return i;
+	// Undo the cumulative sum. If the sum falls short of 1, the rest goes to 0, as a linear
+	// search of the cumulative sum would do.
+	std::vector<double> v(std::max<std::size_t>(p.size(), 1U), 0.0);
+	double previous = 0.0;
+	for (std::size_t i = 0; i < p.size(); i++) {
+		v[i] = std::max(p[i] - previous, 0.0);
+		previous = std::max(p[i], previous);
+	}
+	if (previous < 1.0) {
+		if (previous < 1.0 - 1e-9) {
+			std::cerr << "WARNING: PROBLEM WITH DISEASE DISTRIBUTION [disease::Distribution]" << std::endl;
 		}
+		v[0] += 1.0 - previous;
 	}
-
-	std::cerr << "WARNING: PROBLEM WITH DISEASE DISTRIBUTION [disease::Distribution]" << std::endl;
-	return 0;
+	return std::make_shared<const alias::Alias>(alias::Alias::CreateDistribution(std::move(v)));
 }
 
 std::unique_ptr<Distribution> Distribution::Parse(const ptree& pt_probability_list)
@@ -44,6 +53,21 @@ Fate Disease::Sample(Random& rng) const
 	return Fate{si, ss, si + ti, ss + ts};
 }
 
+void Disease::SampleMany(Random& rng, Fate* fates, std::size_t count, unsigned int num_threads) const
+{
+	const std::size_t block_size = 4096U;
+	const std::size_t num_blocks = (count + block_size - 1) / block_size;
+	const Random block_random(rng(std::numeric_limits<unsigned int>::max()));
+	util::parallel::parallel_for_dynamic(0U, num_blocks, num_threads, [&](std::size_t block, unsigned int) {
+		Random block_rng(block_random);
+		block_rng.Split(static_cast<unsigned int>(num_blocks), static_cast<unsigned int>(block));
+		const std::size_t end = std::min(count, (block + 1) * block_size);
+		for (std::size_t i = block * block_size; i < end; i++) {
+			fates[i] = Sample(block_rng);
+		}
+	});
+}
+
 std::unique_ptr<Disease> Disease::Parse(const ptree& pt_disease)
 {
 	return std::make_unique<Disease>( //
@@ -1,7 +1,11 @@
 #ifndef DISEASE_H_INCLUDED
 #define DISEASE_H_INCLUDED
 
+#include <cstddef>
+#include <memory>
+#include <vector>
 #include <boost/property_tree/ptree.hpp>
+#include "alias/Alias.h"
 #include "util/Random.h"
 
 namespace stride {
@@ -24,19 +28,22 @@ struct Fate
 class Distribution
 {
 public:
-	Distribution(const std::vector<double>& p) : probabilities(p) {}
-	Distribution(std::vector<double>&& p) : probabilities(std::move(p)) {}
+	// Creates a distribution from the cumulative sum of `v`; that is, `p[n]` equals
+	// `sum(k=0..n) v[k]`, an ascending list of reals ending in 1.
+	Distribution(const std::vector<double>& p) : alias(CreateAlias(p)) {}
 
 	// Return a random index into the `probabilities` vector, yielding `i` with
-	// probability `v[i]`.
-	unsigned int Sample(util::Random& rng) const;
+	// probability `v[i]`. This takes a single lookup in an alias table.
+	unsigned int Sample(util::Random& rng) const { return static_cast<unsigned int>(alias->Next(rng)); }
 
 	static std::unique_ptr<Distribution> Parse(const boost::property_tree::ptree& pt_probability_list);
 
 private:
-	// The cumulative sum of `v`; that is, `probabilities[n]` equals `sum(k=0..n) v[k]`.
-	// This means `probabilities` is an ascending list of reals, ending in 1.
-	std::vector<double> probabilities;
+	// Builds the alias table of `v` from its cumulative sum.
+	static std::shared_ptr<const alias::Alias> CreateAlias(const std::vector<double>& p);
+
+	// The alias table of `v`; it does not change, so copies of a distribution share it.
+	std::shared_ptr<const alias::Alias> alias;
 };
 
 // Describes the behavior of a disease, as a record of Distributions
@@ -54,6 +61,11 @@ public:
 
 	Fate Sample(util::Random& rng) const;
 
+	// Fill `fates[0..count)` with samples, in parallel. The fates are cut into fixed blocks that
+	// each get a substream of a generator seeded from `rng`, so the result does not depend on
+	// `num_threads`.
+	void SampleMany(util::Random& rng, Fate* fates, std::size_t count, unsigned int num_threads) const;
+
 	static std::unique_ptr<Disease> Parse(const boost::property_tree::ptree& pt_disease);
 
 private:
@@ -6,6 +6,11 @@ namespace stride {
 
 Health::Health(disease::Fate fate) : m_days_infected(0), m_status(HealthStatus::Susceptible), m_fate(fate) {}
 
+Health::Health(disease::Fate fate, HealthStatus status, unsigned int days_infected)
+    : m_days_infected(days_infected), m_status(status), m_fate(fate)
+{
+}
+
 void Health::SetImmune()
 {
 	m_status = HealthStatus::Immune;
@@ -3,9 +3,12 @@
 
 #include "Disease.h"
 
+#include <cstddef>
+#include <cstdint>
+
 namespace stride {
 
-enum class HealthStatus
+enum class HealthStatus : std::uint8_t
 {
 	Susceptible = 0U,
 	Exposed = 1U,
@@ -16,6 +19,39 @@ enum class HealthStatus
 	Immune = 6U,
 };
 
+/// Number of health statuses.
+inline constexpr unsigned int NumOfHealthStatuses() { return 7U; }
+
+/// Cast for array access.
+inline std::size_t ToSizeType(HealthStatus s) { return static_cast<std::size_t>(s); }
+
+/// Is a person with the given health status immune?
+inline bool IsImmune(HealthStatus status) { return status == HealthStatus::Immune; }
+
+/// Is a person with the given health status infected by the disease?
+inline bool IsInfected(HealthStatus status)
+{
+	return status >= HealthStatus::Exposed && status <= HealthStatus::InfectiousAndSymptomatic;
+}
+
+/// Is a person with the given health status infectious?
+inline bool IsInfectious(HealthStatus status)
+{
+	return status == HealthStatus::Infectious || status == HealthStatus::InfectiousAndSymptomatic;
+}
+
+/// Is a person with the given health status recovered?
+inline bool IsRecovered(HealthStatus status) { return status == HealthStatus::Recovered; }
+
+/// Is a person with the given health status susceptible?
+inline bool IsSusceptible(HealthStatus status) { return status == HealthStatus::Susceptible; }
+
+/// Is a person with the given health status symptomatic?
+inline bool IsSymptomatic(HealthStatus status)
+{
+	return status == HealthStatus::Symptomatic || status == HealthStatus::InfectiousAndSymptomatic;
+}
+
 /*
  * Represents the status of a Person's health at some point in the simulation.
  */
@@ -25,6 +61,12 @@ public:
 	/// Initially, a person is Susceptible, and the "days infected" counter is set to 0.
 	Health(disease::Fate fate);
 
+	/// Restores a health state, e.g. from a row of a PersonStore.
+	Health(disease::Fate fate, HealthStatus status, unsigned int days_infected);
+
+	/// Return the person's fate.
+	const disease::Fate& GetFate() const { return m_fate; }
+
 	/// Return the person's current health status.
 	HealthStatus GetHealthStatus() const { return m_status; }
 
@@ -41,39 +83,22 @@ public:
 	unsigned int GetEndSymptomatic() const { return m_fate.end_symptomatic; }
 
 	/// Return whether the person is currently immune.
-	bool IsImmune() const { return m_status == HealthStatus::Immune; }
+	bool IsImmune() const { return stride::IsImmune(m_status); }
 
 	/// Return whether the person is currently infected by the disease.
-	bool IsInfected() const
-	{
-		switch (m_status) {
-		case HealthStatus::Exposed:
-		case HealthStatus::Infectious:
-		case HealthStatus::Symptomatic:
-		case HealthStatus::InfectiousAndSymptomatic:
-			return true;
-		default:
-			return false;
-		}
-	}
+	bool IsInfected() const { return stride::IsInfected(m_status); }
 
 	///
-	bool IsInfectious() const
-	{
-		return m_status == HealthStatus::Infectious || m_status == HealthStatus::InfectiousAndSymptomatic;
-	}
+	bool IsInfectious() const { return stride::IsInfectious(m_status); }
 
 	///
-	bool IsRecovered() const { return m_status == HealthStatus::Recovered; }
+	bool IsRecovered() const { return stride::IsRecovered(m_status); }
 
 	/// Is this person susceptible?
-	bool IsSusceptible() const { return m_status == HealthStatus::Susceptible; }
+	bool IsSusceptible() const { return stride::IsSusceptible(m_status); }
 
 	/// Is this person symptomatic?
-	bool IsSymptomatic() const
-	{
-		return m_status == HealthStatus::Symptomatic || m_status == HealthStatus::InfectiousAndSymptomatic;
-	}
+	bool IsSymptomatic() const { return stride::IsSymptomatic(m_status); }
 
 	/// Set immune to true.
 	void SetImmune();
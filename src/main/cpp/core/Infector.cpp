@@ -4,9 +4,16 @@
 #include "core/Infector.h"
 #include "core/LogMode.h"
 #include "pop/Person.h"
+#include "util/Bits.h"
+#include "util/Parallel.h"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <tuple>
 #include <utility>
 #include <vector>
 #include <spdlog/spdlog.h>
@@ -33,7 +40,7 @@ template <>
 class R0_POLICY<true>
 {
 public:
-	static void Execute(const Person& p) { p.GetHealth().StopInfection(); }
+	static void Execute(const Person& p) { p.StopInfection(); }
 };
 
 /**
@@ -89,6 +96,38 @@ public:
 	}
 };
 
+/// Member of the stream with the draws that are shared by all members of a cluster; no person has this id.
+const PersonId g_cluster_stream = numeric_limits<PersonId>::max();
+
+/**
+ * Starts the infections of buffered transmissions, ordered by infector, infected person and
+ * cluster type, so that the result does not depend on the order in which clusters were visited.
+ * Only the transmissions that started an infection are kept.
+ */
+template <LogMode log_level, bool track_index_case>
+void StartBufferedInfections(
+    PersonStore& store, vector<Transmission>& transmissions, const CalendarRef& calendar,
+    const shared_ptr<spdlog::logger>& logger)
+{
+	sort(transmissions.begin(), transmissions.end(), [](const Transmission& a, const Transmission& b) {
+		return make_tuple(a.infector, a.infected, a.cluster_type) <
+		       make_tuple(b.infector, b.infected, b.cluster_type);
+	});
+	auto started = transmissions.begin();
+	for (const auto& transmission : transmissions) {
+		if (!IsSusceptible(store.GetHealthStatus(transmission.infected))) {
+			continue;
+		}
+		const Person p1(&store, transmission.infector);
+		const Person p2(&store, transmission.infected);
+		LOG_POLICY<log_level>::Execute(logger, p1, p2, transmission.cluster_type, calendar);
+		p2.StartInfection();
+		R0_POLICY<track_index_case>::Execute(p2);
+		*started++ = transmission;
+	}
+	transmissions.erase(started, transmissions.end());
+}
+
 //--------------------------------------------------------------------------
 // Definition for primary template covers the situation for
 // LogMode::None & LogMode::Transmissions, both with
@@ -97,51 +136,51 @@ public:
 //--------------------------------------------------------------------------
 template <LogMode log_level, bool track_index_case, typename local_information_policy>
 void Infector<log_level, track_index_case, local_information_policy>::Execute(
-    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler, const CalendarRef& calendar,
-    const std::shared_ptr<spdlog::logger>& logger)
+    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler,
+    std::vector<Transmission>& transmissions, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel)
 {
 	cluster.UpdateMemberPresence();
 
 	// set up some stuff
 	const auto c_type = cluster.m_cluster_type;
 	const auto& c_members = cluster.m_members;
-	const auto transmission_rate = disease_profile.GetTransmissionRate();
+	const auto& c_present = cluster.m_member_present;
+	const auto c_store = cluster.m_store;
+	const auto& probabilities = cluster.GetContactProbabilities();
 
 	// check all contacts
 	for (size_t i_person1 = 0; i_person1 < c_members.size(); i_person1++) {
 		// check if member is present today
-		if (c_members[i_person1].second) {
-			auto p1 = c_members[i_person1].first;
-			const double contact_rate = cluster.GetContactRate(p1);
+		if (c_present[i_person1]) {
+			const Person p1(c_store, c_members[i_person1]);
+			const auto contact_probability = probabilities.contact[cluster.GetEffectiveAge(p1.GetIndex())];
+			contact_handler.SetStream(c_type, cluster.m_cluster_id, p1.GetId());
 
 			// loop over possible contacts
 			// FIXME should this loop start from 0? Because of asymm. contact rates
 			for (size_t i_person2 = i_person1 + 1; i_person2 < c_members.size(); i_person2++) {
 				// check if member is present today
-				if (c_members[i_person2].second) {
-					auto p2 = c_members[i_person2].first;
+				if (c_present[i_person2]) {
+					const Person p2(c_store, c_members[i_person2]);
 
 					// check for contact
-					if (contact_handler.HasContact(contact_rate)) {
+					if (contact_handler.Chance(contact_probability)) {
 						// exchange information about health state & beliefs
-						p1.Update(p2.GetData());
-						p2.Update(p1.GetData());
+						p1.Update(p2);
+						p2.Update(p1);
 
-						bool transmission = contact_handler.HasTransmission(transmission_rate);
+						bool transmission = contact_handler.Chance(probabilities.transmission);
 						if (transmission) {
 							if (p1.GetHealth().IsInfectious() &&
 							    p2.GetHealth().IsSusceptible()) {
-								LOG_POLICY<log_level>::Execute(
-								    logger, p1, p2, c_type, calendar);
-								p2.GetHealth().StartInfection();
-								R0_POLICY<track_index_case>::Execute(p2);
+								transmissions.push_back(
+								    {p1.GetIndex(), p2.GetIndex(), c_type});
 							} else if (
 							    p2.GetHealth().IsInfectious() &&
 							    p1.GetHealth().IsSusceptible()) {
-								LOG_POLICY<log_level>::Execute(
-								    logger, p2, p1, c_type, calendar);
-								p1.GetHealth().StartInfection();
-								R0_POLICY<track_index_case>::Execute(p1);
+								transmissions.push_back(
+								    {p2.GetIndex(), p1.GetIndex(), c_type});
 							}
 						}
 					}
@@ -151,98 +190,297 @@ void Infector<log_level, track_index_case, local_information_policy>::Execute(
 	}
 }
 
+template <LogMode log_level, bool track_index_case, typename local_information_policy>
+void Infector<log_level, track_index_case, local_information_policy>::ExecuteSplit(
+    Cluster& cluster, DiseaseProfile disease_profile, std::vector<RngHandler>& contact_handlers,
+    std::vector<std::vector<Transmission>>& transmissions, unsigned int, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel)
+{
+	Execute(cluster, disease_profile, contact_handlers[0], transmissions[0], calendar, logger, kernel);
+}
+
+template <LogMode log_level, bool track_index_case, typename local_information_policy>
+void Infector<log_level, track_index_case, local_information_policy>::StartInfections(
+    PersonStore& store, std::vector<Transmission>& transmissions, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger)
+{
+	StartBufferedInfections<log_level, track_index_case>(store, transmissions, calendar, logger);
+}
+
 //-------------------------------------------------------------------------------------------
 // Definition of partial specialization for LocalInformationPolicy:NoLocalInformation.
 //-------------------------------------------------------------------------------------------
+template <LogMode log_level, bool track_index_case>
+template <typename TAction>
+void Infector<log_level, track_index_case, NoLocalInformation>::SampleTransmissions(
+    const Cluster& cluster, std::size_t i_infected, std::size_t num_cases, RngHandler& contact_handler,
+    TransmissionKernel kernel, const TAction& action)
+{
+	const auto c_immune = cluster.m_index_immune;
+	const auto& c_members = cluster.m_members;
+	const auto& c_present = cluster.m_member_present;
+
+	// check if member is present today
+	// FIXME Is it necessary to check for infectiousness here? Infectious members are
+	// already sorted...
+	const auto index1 = c_members[i_infected];
+	if (!c_present[i_infected] || !IsInfectious(cluster.m_store->GetHealthStatus(index1))) {
+		return;
+	}
+
+	contact_handler.SetStream(cluster.m_cluster_type, cluster.m_cluster_id, cluster.m_store->GetId(index1));
+
+	// FIXME if loop 2 in all contacts algorithm should start from 0, we should also
+	// implement this symmetry here!
+	// Every pair has the same probability of contact and transmission. Absent members get a
+	// trial as well, but it is discarded.
+	const double probability =
+	    cluster.GetContactProbabilities().contact_and_transmission[cluster.GetEffectiveAge(index1)];
+	if (kernel == TransmissionKernel::SkipSampling) {
+		// Jump straight to the next successful trial.
+		std::size_t i_contact = num_cases + contact_handler.SkipTrials(probability, c_immune - num_cases);
+		while (i_contact < c_immune) {
+			if (c_present[i_contact]) {
+				action(i_contact);
+			}
+			i_contact += 1 + contact_handler.SkipTrials(probability, c_immune - i_contact - 1);
+		}
+	} else {
+		// Draw the trials of up to 64 contacts at once and only visit the successful ones.
+		for (size_t first = num_cases; first < c_immune; first += 64) {
+			auto successes = contact_handler.NextTrials(probability, min<size_t>(64, c_immune - first));
+			while (successes != 0) {
+				const size_t i_contact = first + util::count_trailing_zeros(successes);
+				successes &= successes - 1;
+				// check if member is present today
+				if (c_present[i_contact]) {
+					action(i_contact);
+				}
+			}
+		}
+	}
+}
+
+template <LogMode log_level, bool track_index_case>
+template <std::size_t size>
+void Infector<log_level, track_index_case, NoLocalInformation>::ExecuteSmall(
+    Cluster& cluster, RngHandler& contact_handler, std::vector<Transmission>& transmissions)
+{
+	cluster.UpdateMemberPresence();
+	const auto c_store = cluster.m_store;
+	const auto c_type = cluster.m_cluster_type;
+
+	// Bit i is set if the member at position i is present and susceptible, resp. infectious.
+	std::array<PersonIndex, size> members;
+	std::uint64_t susceptible = 0U;
+	std::uint64_t infectious = 0U;
+	for (std::size_t i = 0; i < size; i++) {
+		members[i] = cluster.m_members[i];
+		const auto status = c_store->GetHealthStatus(members[i]);
+		const std::uint64_t present = cluster.m_member_present[i];
+		susceptible |= (present & IsSusceptible(status)) << i;
+		infectious |= (present & IsInfectious(status)) << i;
+	}
+
+	// Every infectious member draws a trial for every position, including its own; only the
+	// trials with present susceptible members count.
+	const auto& probabilities = cluster.GetContactProbabilities().contact_and_transmission;
+	while (infectious != 0) {
+		const auto index1 = members[util::count_trailing_zeros(infectious)];
+		infectious &= infectious - 1;
+		contact_handler.SetStream(c_type, cluster.m_cluster_id, c_store->GetId(index1));
+		const double probability = probabilities[cluster.GetEffectiveAge(index1)];
+		auto successes = contact_handler.NextTrials(probability, size) & susceptible;
+		while (successes != 0) {
+			transmissions.push_back({index1, members[util::count_trailing_zeros(successes)], c_type});
+			successes &= successes - 1;
+		}
+	}
+}
+
+template <LogMode log_level, bool track_index_case>
+void Infector<log_level, track_index_case, NoLocalInformation>::ExecuteMeanField(
+    const Cluster& cluster, std::size_t num_cases, RngHandler& contact_handler,
+    std::vector<Transmission>& transmissions)
+{
+	const auto c_immune = cluster.m_index_immune;
+	const auto& c_members = cluster.m_members;
+	const auto& c_present = cluster.m_member_present;
+	const auto c_type = cluster.m_cluster_type;
+	const auto& probabilities = cluster.GetContactProbabilities().contact_and_transmission;
+
+	// A susceptible member escapes infection if it escapes every present infectious member.
+	vector<PersonIndex> infectors;
+	vector<double> cumulative;
+	double escape = 1.0;
+	double total = 0.0;
+	for (size_t i_infected = 0; i_infected < num_cases; i_infected++) {
+		const auto index1 = c_members[i_infected];
+		if (c_present[i_infected] && IsInfectious(cluster.m_store->GetHealthStatus(index1))) {
+			const double probability = probabilities[cluster.GetEffectiveAge(index1)];
+			escape *= 1.0 - probability;
+			total += probability;
+			infectors.push_back(index1);
+			cumulative.push_back(total);
+		}
+	}
+	if (infectors.empty()) {
+		return;
+	}
+
+	contact_handler.SetStream(c_type, cluster.m_cluster_id, g_cluster_stream);
+	const double probability = 1.0 - escape;
+	for (size_t first = num_cases; first < c_immune; first += 64) {
+		auto successes = contact_handler.NextTrials(probability, min<size_t>(64, c_immune - first));
+		while (successes != 0) {
+			const size_t i_contact = first + util::count_trailing_zeros(successes);
+			successes &= successes - 1;
+			if (c_present[i_contact]) {
+				// Attribute the infection to one of the infectious members.
+				const double draw = contact_handler.NextDouble() * total;
+				const auto it = upper_bound(cumulative.begin(), cumulative.end(), draw);
+				const auto i_infector = min<size_t>(it - cumulative.begin(), infectors.size() - 1);
+				transmissions.push_back({infectors[i_infector], c_members[i_contact], c_type});
+			}
+		}
+	}
+}
+
 template <LogMode log_level, bool track_index_case>
 void Infector<log_level, track_index_case, NoLocalInformation>::Execute(
-    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler, const CalendarRef& calendar,
-    const std::shared_ptr<spdlog::logger>& logger)
+    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler,
+    std::vector<Transmission>& transmissions, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel)
 {
-	// check if the cluster has infected members and sort
-	bool infectious_cases;
-	std::size_t num_cases;
-	tie(infectious_cases, num_cases) = cluster.SortMembers();
+	// Small clusters, most of them households, have a pairwise kernel of their own.
+	if (kernel == TransmissionKernel::Pairwise) {
+		switch (cluster.GetSize()) {
+		case 0:
+		case 1: return;
+		case 2: ExecuteSmall<2>(cluster, contact_handler, transmissions); return;
+		case 3: ExecuteSmall<3>(cluster, contact_handler, transmissions); return;
+		case 4: ExecuteSmall<4>(cluster, contact_handler, transmissions); return;
+		case 5: ExecuteSmall<5>(cluster, contact_handler, transmissions); return;
+		case 6: ExecuteSmall<6>(cluster, contact_handler, transmissions); return;
+		case 7: ExecuteSmall<7>(cluster, contact_handler, transmissions); return;
+		case 8: ExecuteSmall<8>(cluster, contact_handler, transmissions); return;
+		default: break;
+		}
+	}
+
+	// check if the cluster has infectious members; they are among the first num_cases members
+	const bool infectious_cases = cluster.m_num_infectious > 0;
+	const std::size_t num_cases = cluster.m_num_cases;
 
 	if (infectious_cases) {
 		cluster.UpdateMemberPresence();
+		if (kernel == TransmissionKernel::MeanField) {
+			ExecuteMeanField(cluster, num_cases, contact_handler, transmissions);
+			return;
+		}
 
 		// set up some stuff
 		const auto c_type = cluster.m_cluster_type;
-		const auto c_immune = cluster.m_index_immune;
 		const auto& c_members = cluster.m_members;
-		const auto transmission_rate = disease_profile.GetTransmissionRate();
 
 		// match infectious in first part with susceptible in second part, skip last part (immune)
 		for (size_t i_infected = 0; i_infected < num_cases; i_infected++) {
-			// check if member is present today
-			if (c_members[i_infected].second) {
-				const auto p1 = c_members[i_infected].first;
-				// FIXME Is it necessary to check for infectiousness here? Infectious members are
-				// already sorted...
-				if (p1.GetHealth().IsInfectious()) {
-					const double contact_rate = cluster.GetContactRate(p1);
-					// FIXME if loop 2 in all contacts algorithm should start from 0, we should also
-					// implement this symmetry here!
-					for (size_t i_contact = num_cases; i_contact < c_immune; i_contact++) {
-						// check if member is present today
-						if (c_members[i_contact].second) {
-							auto p2 = c_members[i_contact].first;
-							if (contact_handler.HasContactAndTransmission(
-								contact_rate, transmission_rate)) {
-								LOG_POLICY<log_level>::Execute(
-								    logger, p1, p2, c_type, calendar);
-								p2.GetHealth().StartInfection();
-								R0_POLICY<track_index_case>::Execute(p2);
-							}
-						}
-					}
-				}
-			}
+			auto transmit = [&](std::size_t i_contact) {
+				transmissions.push_back({c_members[i_infected], c_members[i_contact], c_type});
+			};
+			SampleTransmissions(cluster, i_infected, num_cases, contact_handler, kernel, transmit);
 		}
 	}
 }
 
+template <LogMode log_level, bool track_index_case>
+void Infector<log_level, track_index_case, NoLocalInformation>::ExecuteSplit(
+    Cluster& cluster, DiseaseProfile disease_profile, std::vector<RngHandler>& contact_handlers,
+    std::vector<std::vector<Transmission>>& transmissions, unsigned int num_threads, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel)
+{
+	// The mean field kernel takes a single pass over the members.
+	if (kernel == TransmissionKernel::MeanField) {
+		Execute(cluster, disease_profile, contact_handlers[0], transmissions[0], calendar, logger, kernel);
+		return;
+	}
+
+	// check if the cluster has infectious members; they are among the first num_cases members
+	const bool infectious_cases = cluster.m_num_infectious > 0;
+	const std::size_t num_cases = cluster.m_num_cases;
+
+	if (infectious_cases) {
+		cluster.UpdateMemberPresence();
+
+		// set up some stuff
+		const auto c_type = cluster.m_cluster_type;
+		const auto& c_members = cluster.m_members;
+
+		// The threads only read the cluster; each one appends to its own transmissions.
+		auto sample = [&](std::size_t i_infected, unsigned int thread_id) {
+			auto& buffer = transmissions[thread_id];
+			auto transmit = [&](std::size_t i_contact) {
+				buffer.push_back({c_members[i_infected], c_members[i_contact], c_type});
+			};
+			auto& handler = contact_handlers[thread_id];
+			SampleTransmissions(cluster, i_infected, num_cases, handler, kernel, transmit);
+		};
+		util::parallel::parallel_for_dynamic(0, num_cases, num_threads, sample);
+	}
+}
+
+template <LogMode log_level, bool track_index_case>
+void Infector<log_level, track_index_case, NoLocalInformation>::StartInfections(
+    PersonStore& store, std::vector<Transmission>& transmissions, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger)
+{
+	StartBufferedInfections<log_level, track_index_case>(store, transmissions, calendar, logger);
+}
+
 //-------------------------------------------------------------------------------------------
 // Definition of partial specialization for LogMode::Contacts and NoLocalInformation policy.
 //-------------------------------------------------------------------------------------------
 template <bool track_index_case>
 void Infector<LogMode::Contacts, track_index_case, NoLocalInformation>::Execute(
-    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler, const CalendarRef& calendar,
-    const std::shared_ptr<spdlog::logger>& logger)
+    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler,
+    std::vector<Transmission>& transmissions, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel)
 {
 	cluster.UpdateMemberPresence();
 
 	// set up some stuff
 	const auto c_type = cluster.m_cluster_type;
 	const auto& c_members = cluster.m_members;
-	const auto transmission_rate = disease_profile.GetTransmissionRate();
+	const auto& c_present = cluster.m_member_present;
+	const auto c_store = cluster.m_store;
+	const auto& probabilities = cluster.GetContactProbabilities();
 
 	// check all contacts
 	for (size_t i_person1 = 0; i_person1 < c_members.size(); i_person1++) {
 		// check if member participates in the social contact survey && member is present today
-		if (c_members[i_person1].second && c_members[i_person1].first.IsParticipatingInSurvey()) {
-			auto p1 = c_members[i_person1].first;
-			const double contact_rate = cluster.GetContactRate(p1);
+		if (c_present[i_person1] && c_store->IsParticipatingInSurvey(c_members[i_person1])) {
+			const Person p1(c_store, c_members[i_person1]);
+			const auto contact_probability = probabilities.contact[cluster.GetEffectiveAge(p1.GetIndex())];
+			contact_handler.SetStream(c_type, cluster.m_cluster_id, p1.GetId());
 			// loop over possible contacts
 			for (size_t i_person2 = i_person1 + 1; i_person2 < c_members.size(); i_person2++) {
 				// check if member is present today
-				if (c_members[i_person2].second) {
-					auto p2 = c_members[i_person2].first;
+				if (c_present[i_person2]) {
+					const Person p2(c_store, c_members[i_person2]);
 					// check for contact
-					if (contact_handler.HasContact(contact_rate)) {
-						bool transmission = contact_handler.HasTransmission(transmission_rate);
+					if (contact_handler.Chance(contact_probability)) {
+						bool transmission = contact_handler.Chance(probabilities.transmission);
 
 						if (transmission) {
 							if (p1.GetHealth().IsInfectious() &&
 							    p2.GetHealth().IsSusceptible()) {
-								p2.GetHealth().StartInfection();
-								R0_POLICY<track_index_case>::Execute(p2);
+								transmissions.push_back(
+								    {p1.GetIndex(), p2.GetIndex(), c_type});
 							} else if (
 							    p2.GetHealth().IsInfectious() &&
 							    p1.GetHealth().IsSusceptible()) {
-								p1.GetHealth().StartInfection();
-								R0_POLICY<track_index_case>::Execute(p1);
+								transmissions.push_back(
+								    {p2.GetIndex(), p1.GetIndex(), c_type});
 							}
 						}
 
@@ -255,6 +493,24 @@ void Infector<LogMode::Contacts, track_index_case, NoLocalInformation>::Execute(
 	}
 }
 
+template <bool track_index_case>
+void Infector<LogMode::Contacts, track_index_case, NoLocalInformation>::ExecuteSplit(
+    Cluster& cluster, DiseaseProfile disease_profile, std::vector<RngHandler>& contact_handlers,
+    std::vector<std::vector<Transmission>>& transmissions, unsigned int, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel)
+{
+	Execute(cluster, disease_profile, contact_handlers[0], transmissions[0], calendar, logger, kernel);
+}
+
+template <bool track_index_case>
+void Infector<LogMode::Contacts, track_index_case, NoLocalInformation>::StartInfections(
+    PersonStore& store, std::vector<Transmission>& transmissions, const CalendarRef& calendar,
+    const std::shared_ptr<spdlog::logger>& logger)
+{
+	// Only contacts are logged.
+	StartBufferedInfections<LogMode::None, track_index_case>(store, transmissions, calendar, logger);
+}
+
 //--------------------------------------------------------------------------
 // All explicit instantiations.
 //--------------------------------------------------------------------------
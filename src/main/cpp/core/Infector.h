@@ -1,10 +1,15 @@
 #ifndef INFECTOR_H_INCLUDED
 #define INFECTOR_H_INCLUDED
 
+#include "core/ClusterType.h"
 #include "core/DiseaseProfile.h"
 #include "core/LogMode.h"
+#include "core/TransmissionKernel.h"
+#include "pop/PersonStore.h"
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 #include <spdlog/spdlog.h>
 
 namespace stride {
@@ -13,6 +18,17 @@ class Cluster;
 class RngHandler;
 class Calendar;
 
+/**
+ * A transmission in a cluster. The infection it causes is only started once all clusters
+ * have been visited, so that clusters can be visited in any order.
+ */
+struct Transmission
+{
+	PersonIndex infector;
+	PersonIndex infected;
+	ClusterType cluster_type;
+};
+
 /**
  * Actual contacts and transmission in cluster (primary template).
  */
@@ -20,23 +36,79 @@ template <LogMode log_level, bool track_index_case, typename local_information_p
 class Infector
 {
 public:
-	///
+	/// Samples the contacts in the cluster and appends the transmissions to the given vector.
 	static void Execute(
-	    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler, const CalendarRef& sim_state,
+	    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler,
+	    std::vector<Transmission>& transmissions, const CalendarRef& sim_state,
+	    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel = TransmissionKernel::Pairwise);
+
+	/// Executes a single cluster with the given number of threads, each using the contact handler and
+	/// transmissions at its thread id. This policy exchanges information between all members and runs
+	/// on one thread.
+	static void ExecuteSplit(
+	    Cluster& cluster, DiseaseProfile disease_profile, std::vector<RngHandler>& contact_handlers,
+	    std::vector<std::vector<Transmission>>& transmissions, unsigned int num_threads,
+	    const CalendarRef& sim_state, const std::shared_ptr<spdlog::logger>& logger,
+	    TransmissionKernel kernel = TransmissionKernel::Pairwise);
+
+	/// Starts the infections of the given transmissions in a fixed order; a person that is infected
+	/// more than once is only infected by the first transmission. Only the transmissions that started
+	/// an infection are kept, in order.
+	static void StartInfections(
+	    PersonStore& store, std::vector<Transmission>& transmissions, const CalendarRef& sim_state,
 	    const std::shared_ptr<spdlog::logger>& logger);
 };
 
 /**
- * Actual contacts and transmissions in cluster (specialization for NoLocalInformation policy)
+ * Actual contacts and transmissions in cluster (specialization for NoLocalInformation policy).
+ * The transmission kernel selects how the contacts between infectious and susceptible members are sampled.
  */
 template <LogMode log_level, bool track_index_case>
 class Infector<log_level, track_index_case, NoLocalInformation>
 {
 public:
-	///
+	/// Samples the contacts in the cluster and appends the transmissions to the given vector.
 	static void Execute(
-	    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler, const CalendarRef& sim_state,
+	    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler,
+	    std::vector<Transmission>& transmissions, const CalendarRef& sim_state,
+	    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel = TransmissionKernel::Pairwise);
+
+	/// Executes a single cluster with the given number of threads, each using the contact handler and
+	/// transmissions at its thread id. The infectious members are divided over the threads.
+	static void ExecuteSplit(
+	    Cluster& cluster, DiseaseProfile disease_profile, std::vector<RngHandler>& contact_handlers,
+	    std::vector<std::vector<Transmission>>& transmissions, unsigned int num_threads,
+	    const CalendarRef& sim_state, const std::shared_ptr<spdlog::logger>& logger,
+	    TransmissionKernel kernel = TransmissionKernel::Pairwise);
+
+	/// Starts the infections of the given transmissions in a fixed order; a person that is infected
+	/// more than once is only infected by the first transmission. Only the transmissions that started
+	/// an infection are kept, in order.
+	static void StartInfections(
+	    PersonStore& store, std::vector<Transmission>& transmissions, const CalendarRef& sim_state,
 	    const std::shared_ptr<spdlog::logger>& logger);
+
+private:
+	/// Samples the transmissions from the infectious member at position i_infected to the susceptible
+	/// members in [num_cases, immune) and calls the action with the position of each infected contact.
+	template <typename TAction>
+	static void SampleTransmissions(
+	    const Cluster& cluster, std::size_t i_infected, std::size_t num_cases, RngHandler& contact_handler,
+	    TransmissionKernel kernel, const TAction& action);
+
+	/// Samples the transmissions in a cluster with the given number of members with the pairwise
+	/// kernel. The members are not sorted and every infectious member draws its trials with all
+	/// others at once, which suits clusters as small as households. Clusters of a type with another
+	/// kernel use that kernel, whatever their size.
+	template <std::size_t size>
+	static void ExecuteSmall(
+	    Cluster& cluster, RngHandler& contact_handler, std::vector<Transmission>& transmissions);
+
+	/// Samples the transmissions from the infectious members at positions [0, num_cases) to the
+	/// susceptible members with one draw per susceptible member (TransmissionKernel::MeanField).
+	static void ExecuteMeanField(
+	    const Cluster& cluster, std::size_t num_cases, RngHandler& contact_handler,
+	    std::vector<Transmission>& transmissions);
 };
 
 /**
@@ -47,9 +119,25 @@ template <bool track_index_case>
 class Infector<LogMode::Contacts, track_index_case, NoLocalInformation>
 {
 public:
-	///
+	/// Samples and logs the contacts in the cluster and appends the transmissions to the given vector.
 	static void Execute(
-	    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler, const CalendarRef& calendar,
+	    Cluster& cluster, DiseaseProfile disease_profile, RngHandler& contact_handler,
+	    std::vector<Transmission>& transmissions, const CalendarRef& calendar,
+	    const std::shared_ptr<spdlog::logger>& logger, TransmissionKernel kernel = TransmissionKernel::Pairwise);
+
+	/// Executes a single cluster with the given number of threads, each using the contact handler and
+	/// transmissions at its thread id. Contacts are logged in order, so this runs on one thread.
+	static void ExecuteSplit(
+	    Cluster& cluster, DiseaseProfile disease_profile, std::vector<RngHandler>& contact_handlers,
+	    std::vector<std::vector<Transmission>>& transmissions, unsigned int num_threads,
+	    const CalendarRef& calendar, const std::shared_ptr<spdlog::logger>& logger,
+	    TransmissionKernel kernel = TransmissionKernel::Pairwise);
+
+	/// Starts the infections of the given transmissions in a fixed order; a person that is infected
+	/// more than once is only infected by the first transmission. Only the transmissions that started
+	/// an infection are kept, in order.
+	static void StartInfections(
+	    PersonStore& store, std::vector<Transmission>& transmissions, const CalendarRef& calendar,
 	    const std::shared_ptr<spdlog::logger>& logger);
 };
 
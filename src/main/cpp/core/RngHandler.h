@@ -1,44 +1,142 @@
 #ifndef RNG_HANDLER_H_INCLUDED
 #define RNG_HANDLER_H_INCLUDED
 
-#include "math.h"
-#include "util/Random.h"
+#include "core/ClusterType.h"
+#include "util/Philox.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 namespace stride {
 
 /**
  * Processes the contacts between persons and determines whether transmission occurs.
+ *
+ * The random numbers come from a counter-based generator. Every member of every cluster has its
+ * own stream on every day, so the draws do not depend on which thread visits a cluster, or when.
  */
 class RngHandler
 {
 public:
-	/// Constructor sets the transmission rate and random number generator.
-	RngHandler(unsigned int seed, unsigned int stream_count, unsigned int id) : m_rng(seed)
+	/// Constructor sets the seed of the random number streams.
+	explicit RngHandler(unsigned long seed)
+	    : m_key{{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 16 >> 16)}}, m_day(0U),
+	      m_counter(), m_buffer(), m_next(m_buffer.size())
+	{
+	}
+
+	/// Sets the day of the streams that are started next.
+	void SetDay(unsigned int day) { m_day = day; }
+
+	/// Starts drawing from the stream of the given member of the given cluster on the current day. Members
+	/// are identified by their person id, which, unlike their row in the person store, is never reused.
+	void SetStream(ClusterType cluster_type, std::size_t cluster_id, std::uint32_t member)
+	{
+		m_counter = {{0U, member, static_cast<std::uint32_t>(cluster_id),
+			      (m_day << 3) | static_cast<std::uint32_t>(ToSizeType(cluster_type))}};
+		m_next = m_buffer.size();
+	}
+
+	/// Get the next random double in [0, 1) of the current stream.
+	double NextDouble()
+	{
+		if (m_next == m_buffer.size()) {
+			Refill();
+		}
+		return m_buffer[m_next++];
+	}
+
+	/// Fills the given array with the next count doubles in [0, 1) of the current stream. This gives
+	/// the same doubles as count calls of NextDouble, but generates most of them in bulk.
+	void NextDoubles(double* out, std::size_t count)
 	{
-		m_rng.Split(stream_count, id);
+		for (; count > 0 && m_next < m_buffer.size(); count--) {
+			*out++ = m_buffer[m_next++];
+		}
+		const std::size_t num_blocks = count / g_doubles_per_block;
+		util::Philox4x32::GenerateDoubles(m_counter, m_key, num_blocks, out);
+		m_counter[0] += static_cast<std::uint32_t>(num_blocks);
+		for (std::size_t i = num_blocks * g_doubles_per_block; i < count; i++) {
+			out[i] = NextDouble();
+		}
 	}
 
+	/// Draws count (at most 64) trials with the given success probability. Bit i of the result
+	/// is set if trial i succeeded.
+	std::uint64_t NextTrials(double probability, std::size_t count)
+	{
+		std::array<double, 64> uniforms;
+		NextDoubles(uniforms.data(), count);
+		std::uint64_t successes = 0U;
+		std::size_t i = 0;
+#ifdef __AVX2__
+		const __m256d threshold = _mm256_set1_pd(probability);
+		for (; i + 4 <= count; i += 4) {
+			const __m256d success = _mm256_cmp_pd(_mm256_loadu_pd(&uniforms[i]), threshold, _CMP_LT_OQ);
+			successes |= static_cast<std::uint64_t>(_mm256_movemask_pd(success)) << i;
+		}
+#endif
+		for (; i < count; i++) {
+			successes |= static_cast<std::uint64_t>(uniforms[i] < probability) << i;
+		}
+		return successes;
+	}
+
+	/// Draws a trial with the given success probability.
+	bool Chance(double probability) { return NextDouble() < probability; }
+
 	/// Convert rate into probability
 	double RateToProbability(double rate) { return 1 - exp(-rate); }
 
-	/// Check if two individuals have transmission.
-	bool HasContactAndTransmission(double contact_rate, double transmission_rate)
+	/// Draw the number of failures before the first success in a series of Bernoulli trials with
+	/// the given success probability (geometric distribution). Returns `limit` if that number is
+	/// at least `limit`.
+	std::size_t SkipTrials(double probability, std::size_t limit)
 	{
-		return m_rng.NextDouble() < RateToProbability(transmission_rate * contact_rate);
+		if (probability <= 0.0) {
+			return limit;
+		}
+		if (probability >= 1.0) {
+			return 0;
+		}
+		const double skip = std::floor(std::log1p(-NextDouble()) / std::log1p(-probability));
+		return skip < static_cast<double>(limit) ? static_cast<std::size_t>(skip) : limit;
 	}
 
-	/// Check if two individuals have contact.
-	bool HasContact(double contact_rate) { return m_rng.NextDouble() < RateToProbability(contact_rate); }
-
-	///
-	bool HasTransmission(double transmission_rate)
+private:
+	/// Generates the next batch of doubles of the current stream.
+	void Refill()
 	{
-		return m_rng.NextDouble() < RateToProbability(transmission_rate);
+		const std::size_t num_blocks = m_buffer.size() / g_doubles_per_block;
+		util::Philox4x32::GenerateDoubles(m_counter, m_key, num_blocks, m_buffer.data());
+		m_counter[0] += static_cast<std::uint32_t>(num_blocks);
+		m_next = 0;
 	}
 
 private:
-	/// Random number engine.
-	util::Random m_rng;
+	/// Number of doubles generated per counter value.
+	static constexpr std::size_t g_doubles_per_block = 4U;
+
+	/// Key of the streams, derived from the seed.
+	util::Philox4x32::Key m_key;
+
+	/// Day of the streams that are started next.
+	unsigned int m_day;
+
+	/// Position in the current stream.
+	util::Philox4x32::Counter m_counter;
+
+	/// Doubles of the current stream that are generated ahead.
+	std::array<double, 16> m_buffer;
+
+	/// Position of the next double in m_buffer.
+	std::size_t m_next;
 };
 
 } // end_of_namespace
@@ -0,0 +1,45 @@
+#include "TransmissionKernel.h"
+
+#include <map>
+#include <string>
+#include <boost/algorithm/string.hpp>
+
+namespace {
+
+using stride::TransmissionKernel;
+using boost::to_upper;
+using namespace std;
+
+map<TransmissionKernel, string> g_transmission_kernel_name{make_pair(TransmissionKernel::Pairwise, "Pairwise"),
+							   make_pair(TransmissionKernel::SkipSampling, "SkipSampling"),
+							   make_pair(TransmissionKernel::MeanField, "MeanField"),
+							   make_pair(TransmissionKernel::Null, "Null")};
+
+map<string, TransmissionKernel> g_name_transmission_kernel{make_pair("PAIRWISE", TransmissionKernel::Pairwise),
+							   make_pair("SKIPSAMPLING", TransmissionKernel::SkipSampling),
+							   make_pair("MEANFIELD", TransmissionKernel::MeanField),
+							   make_pair("NULL", TransmissionKernel::Null)};
+}
+
+namespace stride {
+
+string ToString(TransmissionKernel k)
+{
+	return (g_transmission_kernel_name.count(k) == 1) ? g_transmission_kernel_name[k] : "Null";
+}
+
+bool IsTransmissionKernel(const string& s)
+{
+	std::string t{s};
+	to_upper(t);
+	return (g_name_transmission_kernel.count(t) == 1);
+}
+
+TransmissionKernel ToTransmissionKernel(const string& s)
+{
+	std::string t{s};
+	to_upper(t);
+	return (g_name_transmission_kernel.count(t) == 1) ? g_name_transmission_kernel[t] : TransmissionKernel::Null;
+}
+
+} // namespace
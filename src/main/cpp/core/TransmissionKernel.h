@@ -0,0 +1,38 @@
+#ifndef TRANSMISSION_KERNEL_H_INCLUDED
+#define TRANSMISSION_KERNEL_H_INCLUDED
+
+#include <string>
+
+namespace stride {
+
+/**
+ * Enum specifying how transmissions between the infectious and susceptible members of a cluster are sampled:
+ * \li one Bernoulli draw per (infectious, susceptible) pair
+ * \li geometrically distributed skips between successive transmissions of an infectious member
+ * \li one Bernoulli draw per susceptible member, with the probability that any of the infectious
+ * members transmits to it (mean field, or chain binomial).
+ * All three produce the same distribution of infected persons. The mean field kernel attributes an
+ * infection to one infectious member, chosen with probability proportional to its transmission
+ * probability, where the other kernels take the first of the transmissions to that person. Only the
+ * infectors in the transmission log differ. It takes O(I + S) instead of O(I * S) draws.
+ */
+enum class TransmissionKernel
+{
+	Pairwise = 0U,
+	SkipSampling = 1U,
+	MeanField = 2U,
+	Null
+};
+
+/// Converts a TransmissionKernel value to corresponding name.
+std::string ToString(TransmissionKernel k);
+
+/// Check whether string is name of TransmissionKernel value.
+bool IsTransmissionKernel(const std::string& s);
+
+/// Converts a string with name to TransmissionKernel value.
+TransmissionKernel ToTransmissionKernel(const std::string& s);
+
+} // end_of_namespace
+
+#endif // include-guard
@@ -0,0 +1,197 @@
+#ifndef GEO_GEOGRID_H_INCLUDED
+#define GEO_GEOGRID_H_INCLUDED
+
+#include "geo/GeoPosition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <vector>
+
+namespace stride {
+namespace geo {
+
+/**
+ * An index over the values of a map keyed by GeoPosition, for finding the values within a
+ * distance of a position without visiting the whole map. The positions are put in the cells of
+ * a uniform latitude-longitude grid. A query only visits the cells that can hold positions within
+ * the distance.
+ *
+ * The grid refers to the values of the map, so the map has to outlive the grid, and entries
+ * added to the map after the grid was built are not found.
+ */
+template <typename T>
+class GeoGrid
+{
+public:
+	/// Builds a grid over the given map with cells of about cell_size kilometres along a meridian.
+	GeoGrid(std::map<GeoPosition, T>& map, double cell_size);
+
+	/// Get the map this grid indexes.
+	std::map<GeoPosition, T>& GetMap() const { return m_map; }
+
+	/// Appends the values whose position is less than radius kilometres from the origin to hits, in
+	/// the order of the map. These are the same values a scan of the map with Distance would find.
+	void FindWithin(const GeoPosition& origin, double radius, std::vector<std::reference_wrapper<T>>& hits) const;
+
+private:
+	/// A value of the map in a cell.
+	struct Entry
+	{
+		GeoPosition position;
+		std::size_t rank; ///< Position of the entry in the map.
+		T* value;
+	};
+
+	/// Get the row or column of the cell of the given coordinate, clamped to the grid.
+	static std::size_t GetCell(double coordinate, double min, double cell_degrees, std::size_t count)
+	{
+		const double cell = std::floor((coordinate - min) / cell_degrees);
+		if (!(cell > 0.0)) {
+			return 0;
+		}
+		return std::min(static_cast<std::size_t>(std::min(cell, 1e18)), count - 1);
+	}
+
+private:
+	/// Radius of the Earth in kilometres, as in GeoPosition::Distance.
+	static constexpr double g_earth_radius = 6371.0;
+
+	/// Largest number of cells per entry; the cells are made larger to stay under this.
+	static constexpr std::size_t g_max_cells_per_entry = 4U;
+
+	std::map<GeoPosition, T>& m_map;
+
+	/// South-west corner of the grid.
+	double m_min_latitude;
+	double m_min_longitude;
+
+	/// Size of a cell in degrees, both in latitude and in longitude.
+	double m_cell_degrees;
+
+	std::size_t m_num_rows;
+	std::size_t m_num_columns;
+
+	/// The entries of cell i are at [m_cell_begin[i], m_cell_begin[i + 1]); cells are in row-major order.
+	std::vector<std::size_t> m_cell_begin;
+	std::vector<Entry> m_entries;
+};
+
+template <typename T>
+GeoGrid<T>::GeoGrid(std::map<GeoPosition, T>& map, double cell_size)
+    : m_map(map), m_min_latitude(0.0), m_min_longitude(0.0), m_cell_degrees(1.0), m_num_rows(1U),
+      m_num_columns(1U)
+{
+	double max_latitude = 0.0;
+	double max_longitude = 0.0;
+	if (!map.empty()) {
+		m_min_latitude = m_min_longitude = std::numeric_limits<double>::max();
+		max_latitude = max_longitude = std::numeric_limits<double>::lowest();
+		for (const auto& p : map) {
+			m_min_latitude = std::min(m_min_latitude, p.first.latitude);
+			m_min_longitude = std::min(m_min_longitude, p.first.longitude);
+			max_latitude = std::max(max_latitude, p.first.latitude);
+			max_longitude = std::max(max_longitude, p.first.longitude);
+		}
+	}
+
+	// Cells of the given size, unless that makes too many cells for the number of entries.
+	const double pi = std::acos(-1.0);
+	m_cell_degrees = cell_size > 0.0 ? cell_size / g_earth_radius * 180.0 / pi : 1.0;
+	const std::size_t max_cells = std::max<std::size_t>(1U, g_max_cells_per_entry * map.size());
+	for (;;) {
+		m_num_rows = static_cast<std::size_t>((max_latitude - m_min_latitude) / m_cell_degrees) + 1;
+		m_num_columns = static_cast<std::size_t>((max_longitude - m_min_longitude) / m_cell_degrees) + 1;
+		if (m_num_rows <= max_cells && m_num_columns <= max_cells / m_num_rows) {
+			break;
+		}
+		m_cell_degrees *= 2.0;
+	}
+
+	// Sort the entries by cell; within a cell they stay in the order of the map.
+	std::vector<std::size_t> cells;
+	cells.reserve(map.size());
+	m_entries.reserve(map.size());
+	std::size_t rank = 0;
+	for (auto& p : map) {
+		const auto row = GetCell(p.first.latitude, m_min_latitude, m_cell_degrees, m_num_rows);
+		const auto column = GetCell(p.first.longitude, m_min_longitude, m_cell_degrees, m_num_columns);
+		cells.push_back(row * m_num_columns + column);
+		m_entries.push_back({p.first, rank++, &p.second});
+	}
+	m_cell_begin.assign(m_num_rows * m_num_columns + 1, 0U);
+	for (const auto cell : cells) {
+		m_cell_begin[cell + 1]++;
+	}
+	std::partial_sum(m_cell_begin.begin(), m_cell_begin.end(), m_cell_begin.begin());
+	std::vector<Entry> sorted(m_entries.size());
+	auto next = m_cell_begin;
+	for (std::size_t i = 0; i < m_entries.size(); i++) {
+		sorted[next[cells[i]]++] = m_entries[i];
+	}
+	m_entries.swap(sorted);
+}
+
+template <typename T>
+void GeoGrid<T>::FindWithin(
+    const GeoPosition& origin, double radius, std::vector<std::reference_wrapper<T>>& hits) const
+{
+	if (m_entries.empty() || !(radius > 0.0)) {
+		return;
+	}
+
+	// A position within the radius differs at most radius / R radians in latitude. In longitude, it
+	// differs at most 2 asin(sin(radius / 2R) / cos(latitude)), at the largest latitude in range.
+	// The bounds are widened a little, so that rounding cannot drop positions that Distance accepts.
+	const double pi = std::acos(-1.0);
+	const double margin = 1.0 + 1e-9;
+	const double angle = radius / g_earth_radius;
+	const double delta_latitude = angle * 180.0 / pi * margin + 1e-12;
+	const double max_latitude = std::min(
+	    90.0, std::max(std::abs(origin.latitude - delta_latitude), std::abs(origin.latitude + delta_latitude)));
+	const double min_cosine = std::cos(max_latitude * pi / 180.0);
+	const double sine = min_cosine > 0.0 ? std::sin(angle / 2.0) / min_cosine : 2.0;
+	const double delta_longitude = sine < 1.0 ? 2.0 * std::asin(sine) * 180.0 / pi * margin + 1e-12 : 360.0;
+
+	const auto first_row = GetCell(origin.latitude - delta_latitude, m_min_latitude, m_cell_degrees, m_num_rows);
+	const auto last_row = GetCell(origin.latitude + delta_latitude, m_min_latitude, m_cell_degrees, m_num_rows);
+	std::size_t first_column = 0;
+	std::size_t last_column = m_num_columns - 1;
+	if (origin.longitude - delta_longitude >= -180.0 && origin.longitude + delta_longitude <= 180.0) {
+		// The range does not wrap around the antimeridian.
+		const auto west = origin.longitude - delta_longitude;
+		const auto east = origin.longitude + delta_longitude;
+		first_column = GetCell(west, m_min_longitude, m_cell_degrees, m_num_columns);
+		last_column = GetCell(east, m_min_longitude, m_cell_degrees, m_num_columns);
+	}
+
+	std::vector<const Entry*> found;
+	for (auto row = first_row; row <= last_row; row++) {
+		const auto begin = m_cell_begin[row * m_num_columns + first_column];
+		const auto end = m_cell_begin[row * m_num_columns + last_column + 1];
+		for (auto i = begin; i < end; i++) {
+			if (m_entries[i].position.Distance(origin) < radius) {
+				found.push_back(&m_entries[i]);
+			}
+		}
+	}
+	std::sort(found.begin(), found.end(), [](const Entry* a, const Entry* b) { return a->rank < b->rank; });
+	for (const auto entry : found) {
+		hits.emplace_back(*entry->value);
+	}
+}
+
+template <typename T>
+constexpr double GeoGrid<T>::g_earth_radius;
+
+template <typename T>
+constexpr std::size_t GeoGrid<T>::g_max_cells_per_entry;
+
+} // namespace geo
+} // namespace stride
+
+#endif // end-of-include-guard
@@ -1,13 +1,17 @@
 #ifndef GEO_GEOPOSITION_H_INCLUDED
 #define GEO_GEOPOSITION_H_INCLUDED
 
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
 #include <boost/geometry/geometries/register/multi_point.hpp>
 #include <boost/geometry/geometries/register/point.hpp>
+#include "alias/Alias.h"
+#include "util/Errors.h"
 #include "util/Random.h"
 
 namespace stride {
@@ -75,35 +79,89 @@ namespace geo {
 using GeoPolygon = boost::geometry::model::polygon<GeoPosition>;
 using GeoBox = boost::geometry::model::box<GeoPosition>;
 
+/**
+ * Samples positions uniformly from the convex hull of a set of points. The hull is cut into a fan
+ * of triangles, one of which is picked with an alias table weighted by area, and a position is then
+ * drawn uniformly from that triangle. A sample thus takes a constant number of random draws.
+ */
 class HullSampler
 {
 public:
 	HullSampler(const std::vector<GeoPosition>& points)
+	    : triangle_alias(alias::Alias::CreateDistribution(CreateTriangles(points)))
 	{
-		boost::geometry::convex_hull(points, hull);
-		boost::geometry::envelope(hull, box);
 	}
 
 	GeoPosition Sample(util::Random& random) const
 	{
-		GeoPosition point;
-		do {
-			GeoPosition a = box.min_corner();
-			GeoPosition b = box.max_corner();
-			double ax = a.latitude, ay = a.longitude;
-			double bx = b.latitude, by = b.longitude;
-			double t = random.NextDouble();
-			double u = random.NextDouble();
-			point.latitude = ax * t + bx * (1.0 - t);
-			point.longitude = ay * u + by * (1.0 - u);
-		} while (!boost::geometry::within(point, hull));
-
-		return point;
+		if (triangles.empty()) {
+			// The hull has no area: all points lie on a line.
+			if (vertices.empty()) {
+				FATAL_ERROR("HullSampler::Sample called on empty hull.");
+			}
+			return random.Sample(vertices);
+		}
+
+		const auto& triangle = triangles[triangle_alias.Next(random)];
+		double t = random.NextDouble();
+		double u = random.NextDouble();
+		if (t + u > 1.0) {
+			// Fold the half of the parallelogram outside the triangle back onto it.
+			t = 1.0 - t;
+			u = 1.0 - u;
+		}
+		const auto& a = triangle[0];
+		const auto& b = triangle[1];
+		const auto& c = triangle[2];
+		return {a.latitude + t * (b.latitude - a.latitude) + u * (c.latitude - a.latitude),
+			a.longitude + t * (b.longitude - a.longitude) + u * (c.longitude - a.longitude)};
+	}
+
+	/// Appends count samples to the given positions.
+	void Sample(util::Random& random, std::size_t count, std::vector<GeoPosition>& positions) const
+	{
+		positions.reserve(positions.size() + count);
+		for (std::size_t i = 0; i < count; i++) {
+			positions.push_back(Sample(random));
+		}
 	}
 
 private:
-	GeoPolygon hull;
-	GeoBox box;
+	/// Computes the hull of the points and cuts it into triangles; returns the areas of the triangles.
+	std::vector<double> CreateTriangles(const std::vector<GeoPosition>& points)
+	{
+		GeoPolygon hull;
+		boost::geometry::convex_hull(points, hull);
+
+		// The outer ring of the hull is closed: its last point is its first one.
+		vertices = hull.outer();
+		if (vertices.size() > 1) {
+			vertices.pop_back();
+		}
+
+		std::vector<double> areas;
+		for (std::size_t i = 1; i + 1 < vertices.size(); i++) {
+			const auto& a = vertices[0];
+			const auto& b = vertices[i];
+			const auto& c = vertices[i + 1];
+			const double area = std::abs(
+			    (b.latitude - a.latitude) * (c.longitude - a.longitude) -
+			    (c.latitude - a.latitude) * (b.longitude - a.longitude));
+			if (area > 0.0) {
+				triangles.push_back({{a, b, c}});
+				areas.push_back(area);
+			}
+		}
+		if (areas.empty()) {
+			// An alias table needs at least one value; it is not used without triangles.
+			areas.push_back(1.0);
+		}
+		return areas;
+	}
+
+	std::vector<GeoPosition> vertices;
+	std::vector<std::array<GeoPosition, 3>> triangles;
+	alias::Alias triangle_alias;
 };
 
 } // namespace
@@ -1,8 +1,11 @@
 #ifndef GEO_PROFILE_H_INCLUDED
 #define GEO_PROFILE_H_INCLUDED
 
+#include <cstddef>
 #include <fstream>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "City.h"
 #include "util/Random.h"
 
@@ -15,8 +18,8 @@ using ProfileRef = std::shared_ptr<const Profile>;
 class Profile
 {
 public:
-	Profile(const std::vector<City>& cities, const HullSampler& hull_sampler)
-	    : m_cities(cities), m_hull_sampler(hull_sampler)
+	Profile(const std::vector<City>& cities, HullSampler&& hull_sampler)
+	    : m_cities(cities), m_hull_sampler(std::move(hull_sampler))
 	{
 		std::sort(m_cities.begin(), m_cities.end(), [](const City& a, const City& b) {
 			return a.relative_population > b.relative_population;
@@ -30,6 +33,12 @@ public:
 	/// Get a random geoposition in the simulation area.
 	GeoPosition GetRandomGeoPosition(util::Random& random) const { return m_hull_sampler.Sample(random); }
 
+	/// Append count random geopositions in the simulation area to the given positions.
+	void GetRandomGeoPositions(util::Random& random, std::size_t count, std::vector<GeoPosition>& positions) const
+	{
+		m_hull_sampler.Sample(random, count, positions);
+	}
+
 	static ProfileRef Parse(std::ifstream& csv_file);
 
 private:
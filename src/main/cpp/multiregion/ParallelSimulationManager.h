@@ -9,6 +9,7 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 #include <spdlog/spdlog.h>
 #include "multiregion/LocalSimulationTask.h"
 #include "multiregion/SequentialSimulationManager.h"
@@ -52,13 +53,35 @@ private:
 		ParallelSimulationManager<TResult, TInitialResultArgs...>* manager;
 	};
 
+	/// Tries to pop a task that is ready to perform a time step and marks it as running. A task that
+	/// becomes ready while it is still running its previous step is only marked ready again after it.
 	bool TryPopReady(RegionId& id)
 	{
-		auto success = comm_data.TryPopReady(id);
-		if (success) {
-			comm_data.ResetDependencies(id, tasks[id]->GetConnectedRegions());
+		while (comm_data.TryPopReady(id)) {
+			if (running_tasks.count(id) > 0) {
+				ready_running_tasks.insert(id);
+			} else if (!tasks[id]->IsDone()) {
+				comm_data.ResetDependencies(id, tasks[id]->GetConnectedRegions());
+				running_tasks.insert(id);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// Marks the given task, which has performed a time step, as no longer running.
+	void FinishStep(RegionId id)
+	{
+		running_tasks.erase(id);
+		const auto& task = tasks[id];
+		if (task->IsDone()) {
+			// Waiting until the task is ready once more would wait for the other tasks to push,
+			// and the ones that are done never push again, so neither should the others wait for them.
+			comm_data.MarkFinished(id, task->GetConnectedRegions());
+			--active_task_count;
+		} else if (ready_running_tasks.erase(id) > 0) {
+			comm_data.MarkReady(id);
 		}
-		return success;
 	}
 
 	TaskCommunicationData comm_data;
@@ -68,6 +91,12 @@ private:
 	unsigned int number_of_sim_threads;
 	volatile std::size_t active_task_count;
 
+	/// The tasks that are performing a time step.
+	std::unordered_set<RegionId> running_tasks;
+
+	/// The running tasks that became ready again during their time step.
+	std::unordered_set<RegionId> ready_running_tasks;
+
 public:
 	ParallelSimulationManager(std::size_t number_of_task_threads, unsigned int number_of_sim_threads)
 	    : number_of_task_threads(number_of_task_threads), number_of_sim_threads(number_of_sim_threads),
@@ -87,7 +116,9 @@ public:
 		    sim, ParallelTaskCommunicator(id, this), args..., configuration.common_config->generate_vis_file);
 		tasks[id] = task;
 		comm_data.MarkReady(id);
-		active_task_count++;
+		if (!task->IsDone()) {
+			active_task_count++;
+		}
 		return task;
 	}
 
@@ -104,7 +135,9 @@ public:
 		    sim, ParallelTaskCommunicator(id, this), args..., configuration.common_config->generate_vis_file);
 		tasks[id] = task;
 		comm_data.MarkReady(id);
-		active_task_count++;
+		if (!task->IsDone()) {
+			active_task_count++;
+		}
 		return task;
 	}
 #endif
@@ -116,8 +149,7 @@ public:
 		std::vector<std::thread> threads;
 		for (std::size_t i = 0; i < number_of_task_threads; i++) {
 			threads.emplace_back([this]() {
-				// We will leave at least one thread running until the number of active tasks reaches
-				// zero.
+				// Keep running until the number of active tasks reaches zero.
 				while (active_task_count > 0) {
 					// Acquire a lock, so we don't get weird race conditions like popping the same
 					// task twice.
@@ -126,23 +158,14 @@ public:
 					// Try to pop a task that's ready to perform a time step.
 					RegionId ready_id;
 					if (TryPopReady(ready_id)) {
+						// Have the task perform a single step. Release the communication lock
+						// early so other threads can proceed.
 						auto task = tasks[ready_id];
-						if (task->IsDone()) {
-							// This task's done. We ought to decrement the active task
-							// counter and we can also consider ending this thread.
-							auto count = --active_task_count;
-							comm_mutex.unlock();
-							if (count < number_of_task_threads) {
-								// End this thread of execution. We don't need it
-								// anymore.
-								break;
-							}
-						} else {
-							// Have the task perform a single step. Release the
-							// communication lock early so other threads can proceed.
-							comm_mutex.unlock();
-							task->Step();
-						}
+						comm_mutex.unlock();
+						task->Step();
+
+						std::lock_guard<std::mutex> lock(comm_mutex);
+						FinishStep(ready_id);
 					} else {
 						// No task was ready. Free the lock to give the other tasks the
 						// opportunity to push their outputs and try again.
@@ -116,14 +116,33 @@ public:
 		}
 	}
 
-	/// Resets the dependencies of the region with the given id.
+	/// Resets the dependencies of the region with the given id. Finished regions are not waited for.
 	void ResetDependencies(RegionId id, const std::unordered_set<RegionId>& dependencies)
 	{
-		buffers[id].ResetDependencies(dependencies);
+		auto unfinished = dependencies;
+		for (const auto& finished : finished_tasks) {
+			unfinished.erase(finished);
+		}
+		buffers[id].ResetDependencies(unfinished);
+	}
+
+	/// Marks the task with the given id and dependencies as finished: it will not push anymore, so
+	/// the tasks that depend on it stop waiting for it.
+	void MarkFinished(RegionId id, const std::unordered_set<RegionId>& dependencies)
+	{
+		finished_tasks.insert(id);
+		for (const auto& dep : dependencies) {
+			auto& buf = buffers[dep];
+			buf.SatisfyDependency(id);
+			if (buf.IsReady()) {
+				MarkReady(dep);
+			}
+		}
 	}
 
 private:
 	std::unordered_set<RegionId> ready_tasks;
+	std::unordered_set<RegionId> finished_tasks;
 	std::unordered_map<RegionId, TaskCommunicationBuffer> buffers;
 };
 
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <cstddef>
+#include <limits>
 #include <map>
 #include <memory>
 #include <numeric>
@@ -56,7 +57,10 @@ V SumValues(const std::map<K, V>& map)
 	return sum;
 }
 
-Population Generator::Generate()
+/// Calculate how many facilities of the given size it takes to serve n people.
+int CountFacilities(int n, int size) { return n > 0 && size > 0 ? (n + size - 1) / size : 0; }
+
+Population Generator::Generate(unsigned int num_threads)
 {
 	// Types used in this method.
 	using stride::geo::GeoPosition;
@@ -167,21 +171,20 @@ Population Generator::Generate()
 	{
 		Debug("Generating schools...");
 		SchoolClusterId school_cluster_id = 1;
-		int schools_created = 0;
 
 		auto school_geo_brng = GeoBRNG::CreateDistribution(school_population_distribution, random);
 		const int clusters_per_school = model->school_size / model->school_cluster_size;
 
-		n = SumValues(school_population_distribution);
-		while (n > 0) {
-			auto& vec = schools[school_geo_brng.Next()];
+		std::vector<GeoPosition> positions;
+		school_geo_brng.NextN(
+		    CountFacilities(SumValues(school_population_distribution), model->school_size), positions);
+		for (const auto& position : positions) {
+			auto& vec = schools[position];
 			vec.emplace_back(School());
 			for (int i = 0; i < clusters_per_school; i++)
 				vec.back().emplace_back(school_cluster_id++);
-			n -= model->school_size;
-			schools_created++;
 		}
-		Debug("Created {} schools.", schools_created);
+		Debug("Created {} schools.", positions.size());
 
 		// Generate colleges.
 		Debug("Generating colleges...");
@@ -216,91 +219,134 @@ Population Generator::Generate()
 	{
 		Debug("Generating workplaces...");
 		WorkClusterId work_cluster_id = 1;
-		int workplaces_created = 0;
 
-		n = SumValues(work_population_distribution);
-		while (n > 0) {
-			workplaces[work_geo_brng.Next()].emplace_back(work_cluster_id++);
-			n -= model->workplace_size;
-			workplaces_created++;
+		std::vector<GeoPosition> positions;
+		work_geo_brng.NextN(
+		    CountFacilities(SumValues(work_population_distribution), model->workplace_size), positions);
+		for (const auto& position : positions) {
+			workplaces[position].emplace_back(work_cluster_id++);
 		}
-		Debug("Created {} workplaces.", workplaces_created);
+		Debug("Created {} workplaces.", positions.size());
 	}
 
 	// Generate communities.
 	{
 		Debug("Generating primary communities...");
 		CommunityClusterId primary_community_cluster_id = 1;
-		int primary_communities_created = 0;
 
-		n = SumValues(population_distribution);
-		while (n > 0) {
-			primary_communities[geo_brng.Next()].emplace_back(primary_community_cluster_id++);
-			n -= model->community_size;
-			primary_communities_created++;
+		std::vector<GeoPosition> positions;
+		geo_brng.NextN(CountFacilities(SumValues(population_distribution), model->community_size), positions);
+		for (const auto& position : positions) {
+			primary_communities[position].emplace_back(primary_community_cluster_id++);
 		}
 
-		Debug("Created {} primary communities.", primary_communities_created);
+		Debug("Created {} primary communities.", positions.size());
 	}
 
 	// Generate secondary communities.
 	{
 		Debug("Generating secondary communities...");
 		CommunityClusterId secondary_community_cluster_id = 1;
-		int secondary_communities_created = 0;
 
-		n = SumValues(population_distribution);
-		while (n > 0) {
-			secondary_communities[geo_brng.Next()].emplace_back(secondary_community_cluster_id++);
-			n -= model->community_size;
-			secondary_communities_created++;
+		std::vector<GeoPosition> positions;
+		geo_brng.NextN(CountFacilities(SumValues(population_distribution), model->community_size), positions);
+		for (const auto& position : positions) {
+			secondary_communities[position].emplace_back(secondary_community_cluster_id++);
 		}
 
-		Debug("Created {} secondary communities.", secondary_communities_created);
+		Debug("Created {} secondary communities.", positions.size());
 	}
 
-	// Generate people.
+	// Index the facilities by location, so that finding the ones near a person does not visit all of them.
+	const geo::GeoGrid<std::vector<School>> school_grid(schools, model->search_radius);
+	const geo::GeoGrid<College> college_grid(colleges, model->search_radius);
+	const geo::GeoGrid<std::vector<WorkClusterId>> workplace_grid(workplaces, model->search_radius);
+	const geo::GeoGrid<std::vector<CommunityClusterId>> primary_community_grid(
+	    primary_communities, model->search_radius);
+	const geo::GeoGrid<std::vector<CommunityClusterId>> secondary_community_grid(
+	    secondary_communities, model->search_radius);
+
+	// Generate people. The households of each location are a unit of work with its own substream of a
+	// random number generator that is seeded from the generator's one. The units take their person and
+	// household ids from consecutive ranges, in the order of the household map, so that the people do not
+	// depend on the order in which the units are done.
 	{
 		Debug("Generating people...");
-		HouseholdClusterId household_id = 1;
-		ClusterId person_id = 1;
-
+		struct GeneratedPerson
+		{
+			int age;
+			HouseholdClusterId household_id;
+			int school_id;
+			int work_id;
+			int primary_community_id;
+			int secondary_community_id;
+			disease::Fate fate;
+		};
+
+		std::vector<const std::pair<const GeoPosition, std::vector<ReferenceHousehold>>*> units;
+		std::vector<std::size_t> first_person{0U};
+		std::vector<HouseholdClusterId> first_household{1U};
 		for (const auto& p : households) {
-			const auto& home = p.first;
+			units.push_back(&p);
+			std::size_t num_people = 0U;
 			for (const auto& rh : p.second) {
+				num_people += rh.ages.size();
+			}
+			first_person.push_back(first_person.back() + num_people);
+			first_household.push_back(first_household.back() + p.second.size());
+		}
+
+		const util::Random unit_random(random(std::numeric_limits<unsigned int>::max()));
+		std::vector<GeneratedPerson> people(first_person.back());
+		const auto generate_unit = [&](std::size_t unit, unsigned int) {
+			util::Random rng(unit_random);
+			rng.Split(units.size(), unit);
+
+			const auto& home = units[unit]->first;
+			auto person = people.begin() + first_person[unit];
+			auto household_id = first_household[unit];
+			for (const auto& rh : units[unit]->second) {
 				for (const int age : rh.ages) {
 					int school_id = 0;
 					int work_id = 0;
 					if (model->IsSchoolAge(age)) {
-						school_id = random.Sample(random.Sample(FindLocal(home, schools)));
+						school_id = rng.Sample(rng.Sample(FindLocal(home, school_grid, rng)));
 					} else if (model->IsCollegeAge(age)) {
-						bool commutes = random.Chance(model->college_commute_ratio);
-						school_id = random.Sample(
-						    commutes ? colleges[college_brng.Next()]
-							     : FindLocal(home, colleges));
-					} else if (
-					    model->IsEmployableAge(age) && random.Chance(model->employed_ratio)) {
+						bool commutes = rng.Chance(model->college_commute_ratio);
+						school_id = rng.Sample(
+						    commutes ? colleges.at(college_brng.Next(rng))
+							     : FindLocal(home, college_grid, rng));
+					} else if (model->IsEmployableAge(age) && rng.Chance(model->employed_ratio)) {
 						// TODO: technically, commuters should commute to workplaces in big
 						// cities, not just random ones.
-						bool commutes = random.Chance(model->work_commute_ratio);
-						work_id = random.Sample(
-						    FindLocal(commutes ? work_geo_brng.Next() : home, workplaces));
+						bool commutes = rng.Chance(model->work_commute_ratio);
+						const auto origin = commutes ? work_geo_brng.Next(rng) : home;
+						work_id = rng.Sample(FindLocal(origin, workplace_grid, rng));
 					}
 
-					int primary_community_id = random.Sample(FindLocal(home, primary_communities));
+					int primary_community_id =
+					    rng.Sample(FindLocal(home, primary_community_grid, rng));
 					int secondary_community_id =
-					    random.Sample(FindLocal(home, secondary_communities));
-
-					population.emplace(
-					    person_id++, age, household_id, school_id, work_id, primary_community_id,
-					    secondary_community_id, disease.Sample(random));
-
-					if (person_id % 10000 == 0) {
-						Debug("Person {}...", person_id);
-					}
+					    rng.Sample(FindLocal(home, secondary_community_grid, rng));
+
+					*person++ = {age,
+						     household_id,
+						     school_id,
+						     work_id,
+						     primary_community_id,
+						     secondary_community_id,
+						     disease.Sample(rng)};
 				}
 				household_id++;
 			}
+		};
+		util::parallel::parallel_for_dynamic(0U, units.size(), num_threads, generate_unit);
+
+		ClusterId person_id = 1;
+		for (const auto& person : people) {
+			population.emplace(
+			    person_id++, person.age, person.household_id, person.school_id, person.work_id,
+			    person.primary_community_id, person.secondary_community_id, person.fate);
 		}
 		Debug("Generated {} people.", person_id - 1);
 	}
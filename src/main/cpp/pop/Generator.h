@@ -15,6 +15,7 @@
 #include "Person.h"
 #include "alias/Alias.h"
 #include "core/Disease.h"
+#include "geo/GeoGrid.h"
 #include "geo/Profile.h"
 #include "pop/Population.h"
 #include "sim/SimulationConfig.h"
@@ -42,8 +43,9 @@ public:
 	static std::unique_ptr<Generator> FromConfig(
 	    const SingleSimulationConfig& config, const disease::Disease& disease, util::Random& rng);
 
-	/// Generate a random population.
-	Population Generate();
+	/// Generate a random population. The people are generated by num_threads threads; the population
+	/// only depends on the random number generator, not on the number of threads.
+	Population Generate(unsigned int num_threads = 1U);
 
 	/// Check if a population fits the model.
 	/// If verbose is true, log the checks performed.
@@ -57,7 +59,7 @@ public:
 			return;
 		auto console = spdlog::get("popgen");
 		if (!console) {
-			console = spdlog::stderr_logger_st("popgen");
+			console = spdlog::stderr_logger_mt("popgen");
 			console->set_level(spdlog::level::debug);
 			console->set_pattern("\x1b[36;1m[popgen] %v\x1b[0m");
 		}
@@ -87,10 +89,12 @@ private:
 	/// Generate a random GeoPosition in the simulation area.
 	geo::GeoPosition GetRandomGeoPosition() { return geo_profile->GetRandomGeoPosition(random); }
 
-	/// Find a random GeoPosition map value close to the given origin point.
+	/// Find a random GeoPosition map value close to the given origin point, using the grid over that map
+	/// and the given random number generator.
 	template <typename T>
-	T& FindLocal(const geo::GeoPosition& origin, std::map<geo::GeoPosition, T>& map, int tries = 5)
+	T& FindLocal(const geo::GeoPosition& origin, const geo::GeoGrid<T>& grid, util::Random& rng, int tries = 5)
 	{
+		auto& map = grid.GetMap();
 		if (map.empty()) {
 			FATAL_ERROR("Generator::FindLocal called on empty map.");
 		}
@@ -98,19 +102,15 @@ private:
 		double r = model->search_radius;
 		std::vector<std::reference_wrapper<T>> hits;
 		for (int i = 0; i < tries; i++, r *= 2.0) {
-			for (auto& p : map) {
-				if (p.first.Distance(origin) < r) {
-					hits.emplace_back(p.second);
-				}
-			}
+			grid.FindWithin(origin, r, hits);
 			if (!hits.empty()) {
-				return random.Sample(hits).get();
+				return rng.Sample(hits).get();
 			}
 		}
 
 		Debug("FindLocal: giving up after {} radius expansions", tries);
 		auto it = map.begin();
-		std::advance(it, random(map.size()));
+		std::advance(it, rng(map.size()));
 		const double distance = it->first.Distance(origin);
 		Debug("Settling on distance {} between {} and {}", distance, it->first.ToString(), origin.ToString());
 		return it->second;
@@ -1,6 +1,7 @@
 #ifndef PERSON_H_INCLUDED
 #define PERSON_H_INCLUDED
 
+#include "PersonStore.h"
 #include "core/Disease.h"
 #include "core/Health.h"
 
@@ -16,177 +17,104 @@
 
 namespace stride {
 
-using PersonId = unsigned int;
-
 class Calendar;
 enum class ClusterType;
 
 /**
- * Store and handle person data.
- */
-template <class BehaviourPolicy, class BeliefPolicy>
-class GenericPersonData
-{
-public:
-	/// Creates a person from the given data.
-	GenericPersonData(
-	    double age, unsigned int household_id, unsigned int school_id, unsigned int work_id,
-	    unsigned int primary_community_id, unsigned int secondary_community_id, disease::Fate fate,
-	    double risk_averseness = 0)
-	    : m_age(age), m_gender('M'), m_household_id(household_id), m_school_id(school_id), m_work_id(work_id),
-	      m_primary_community_id(primary_community_id), m_secondary_community_id(secondary_community_id),
-	      m_at_household(true), m_at_school(true), m_at_work(true), m_at_primary_community(true),
-	      m_at_secondary_community(true), m_health(fate), m_is_participant(false)
-	{
-		BeliefPolicy::Initialize(m_belief_data, risk_averseness);
-	}
-
-	/// Get the age.
-	double GetAge() const { return m_age; }
-
-	/// Get cluster ID of cluster_type
-	unsigned int GetClusterId(ClusterType cluster_type) const;
-
-	/// Get cluster ID of cluster_type
-	unsigned int& GetClusterId(ClusterType cluster_type);
-
-	/// Return person's gender.
-	char GetGender() const { return m_gender; }
-
-	/// Return person's health status.
-	Health& GetHealth() { return m_health; }
-
-	/// Return person's health status.
-	const Health& GetHealth() const { return m_health; }
-
-	/// Return person's belief status.
-	const typename BeliefPolicy::Data& GetBeliefData() const { return m_belief_data; }
-
-	/// Check if a person is present today in a given cluster
-	bool IsInCluster(ClusterType c) const;
-
-	/// Does this person participates in the social contact study?
-	bool IsParticipatingInSurvey() const { return m_is_participant; }
-
-	/// Participate in social contact study and log person details
-	void ParticipateInSurvey() { m_is_participant = true; }
-
-	/// Update the health status and presence in clusters.
-	void Update(bool is_work_off, bool is_school_off, double fraction_infected);
-
-	/// Update belief & behaviour upon meeting another Person
-	void Update(std::shared_ptr<const GenericPersonData> p);
-
-private:
-	double m_age;
-	char m_gender;
-
-	/// Which communities does this person belong to?
-	unsigned int m_household_id;
-	unsigned int m_school_id;
-	unsigned int m_work_id;
-	unsigned int m_primary_community_id;
-	unsigned int m_secondary_community_id;
-
-	/// Which of those communities are they present at today?
-	bool m_at_household;
-	bool m_at_school;
-	bool m_at_work;
-	bool m_at_primary_community;
-	bool m_at_secondary_community;
-
-	/// Health info for this person.
-	Health m_health;
-
-	/// Info about this Person's health beliefs.
-	typename BeliefPolicy::Data m_belief_data;
-
-	/// Is this person participating in the social contact study?
-	bool m_is_participant;
-};
-
-extern template class GenericPersonData<NoBehaviour, NoBelief>;
-extern template class GenericPersonData<AlwaysFollowBeliefs, Threshold<true, false>>;
-extern template class GenericPersonData<AlwaysFollowBeliefs, Threshold<false, true>>;
-extern template class GenericPersonData<AlwaysFollowBeliefs, Threshold<true, true>>;
-
-/**
- * Describes a person: personal data tagged by an id.
+ * Describes a person: a lightweight handle to a row of a person store.
+ * Persons that do not belong to a population own a single-row store of their own.
  */
 template <class BehaviourPolicy, class BeliefPolicy>
 class GenericPerson
 {
 public:
-	using PersonData = GenericPersonData<BehaviourPolicy, BeliefPolicy>;
+	using Store = GenericPersonStore<BehaviourPolicy, BeliefPolicy>;
+
 	/// Creates a person from the given information.
 	GenericPerson(
 	    PersonId id, double age, unsigned int household_id, unsigned int school_id, unsigned int work_id,
 	    unsigned int primary_community_id, unsigned int secondary_community_id, disease::Fate fate,
 	    double risk_averseness = 0)
-	    : m_id(id), m_data(
-			    std::make_shared<PersonData>(
-				age, household_id, school_id, work_id, primary_community_id, secondary_community_id,
-				fate, risk_averseness))
+	    : m_owned_store(std::make_shared<Store>())
 	{
+		m_store = m_owned_store.get();
+		m_index = m_store->Emplace(
+		    id, age, household_id, school_id, work_id, primary_community_id, secondary_community_id, fate,
+		    risk_averseness);
 	}
 
-	/// Creates a person from the given id and data.
-	GenericPerson(PersonId id, const std::shared_ptr<PersonData>& data) : m_id(id), m_data(data) {}
+	/// Creates a handle to the person at the given index of the given store.
+	GenericPerson(Store* store, PersonIndex index) : m_store(store), m_index(index) {}
 
 	/// Checks if this person is equal to the given person.
-	bool operator==(const GenericPerson& p) const { return m_id == p.m_id; }
+	bool operator==(const GenericPerson& p) const { return GetId() == p.GetId(); }
 
 	/// Checks if this person is not equal to the given person.
 	bool operator!=(const GenericPerson& p) const { return !(*this == p); }
 
 	/// Get the age.
-	double GetAge() const { return m_data->GetAge(); }
+	double GetAge() const { return m_store->GetAge(m_index); }
 
 	/// Get cluster ID of cluster_type
-	unsigned int& GetClusterId(ClusterType cluster_type) const { return m_data->GetClusterId(cluster_type); }
+	unsigned int GetClusterId(ClusterType cluster_type) const
+	{
+		return m_store->GetClusterId(m_index, cluster_type);
+	}
 
 	/// Return person's gender.
-	char GetGender() const { return m_data->GetGender(); }
+	char GetGender() const { return 'M'; }
 
 	/// Return person's health status.
-	Health& GetHealth() const { return m_data->GetHealth(); }
+	Health GetHealth() const { return m_store->GetHealth(m_index); }
+
+	/// Overwrite person's health status.
+	void SetHealth(const Health& health) const { m_store->SetHealth(m_index, health); }
+
+	/// Make this person immune.
+	void SetImmune() const { m_store->SetImmune(m_index); }
+
+	/// Start this person's infection.
+	void StartInfection() const { m_store->StartInfection(m_index); }
+
+	/// Stop this person's infection.
+	void StopInfection() const { m_store->StopInfection(m_index); }
 
 	/// Return person's belief status.
-	const typename BeliefPolicy::Data& GetBeliefData() const { return m_data->GetBeliefData(); }
+	const typename BeliefPolicy::Data& GetBeliefData() const { return m_store->GetBeliefData(m_index); }
 
 	/// Get the id.
-	PersonId GetId() const { return m_id; }
+	PersonId GetId() const { return m_store->GetId(m_index); }
+
+	/// Get the index of this person in its store.
+	PersonIndex GetIndex() const { return m_index; }
 
 	/// Creates a deep copy of this person, including its data.
-	GenericPerson Clone() const { return GenericPerson(m_id, std::make_shared<PersonData>(*m_data)); }
+	GenericPerson Clone() const { return WithId(GetId()); }
 
 	/// Creates a deep copy of this person and gives it the given id.
 	GenericPerson WithId(PersonId new_id) const;
 
 	/// Check if a person is present today in a given cluster
-	bool IsInCluster(ClusterType c) const { return m_data->IsInCluster(c); }
+	bool IsInCluster(ClusterType c) const { return m_store->IsInCluster(m_index, c); }
 
 	/// Does this person participates in the social contact study?
-	bool IsParticipatingInSurvey() const { return m_data->IsParticipatingInSurvey(); }
+	bool IsParticipatingInSurvey() const { return m_store->IsParticipatingInSurvey(m_index); }
 
 	/// Participate in social contact study and log person details
-	void ParticipateInSurvey() const { m_data->ParticipateInSurvey(); }
-
-	/// Update the health status and presence in clusters.
-	void Update(bool is_work_off, bool is_school_off, double fraction_infected) const
-	{
-		m_data->Update(is_work_off, is_school_off, fraction_infected);
-	}
+	void ParticipateInSurvey() const { m_store->ParticipateInSurvey(m_index); }
 
 	/// Update belief & behaviour upon meeting another Person
-	void Update(std::shared_ptr<const PersonData> p) const { m_data->Update(p); }
+	void Update(const GenericPerson& p) const { m_store->UpdateBelief(m_index, p); }
 
-	/// Gets the data that backs this person.
-	std::shared_ptr<PersonData> GetData() const { return m_data; }
+	/// Gets the store that backs this person.
+	Store* GetStore() const { return m_store; }
 
 private:
-	PersonId m_id;
-	std::shared_ptr<PersonData> m_data;
+	Store* m_store;
+	PersonIndex m_index;
+
+	/// Keeps the store of a person that is not part of a population alive.
+	std::shared_ptr<Store> m_owned_store;
 };
 
 extern template class GenericPerson<NoBehaviour, NoBelief>;
@@ -195,7 +123,6 @@ extern template class GenericPerson<AlwaysFollowBeliefs, Threshold<false, true>>
 extern template class GenericPerson<AlwaysFollowBeliefs, Threshold<true, true>>;
 
 // TODO: Where does this belong; here or Simulator?
-using PersonData = GenericPersonData<NoBehaviour, NoBelief>;
 using Person = GenericPerson<NoBehaviour, NoBelief>;
 
 } // end_of_namespace
@@ -0,0 +1,400 @@
+#include "PersonStore.h"
+
+#include "util/Errors.h"
+#include "util/Numa.h"
+#include "util/Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+
+namespace stride {
+
+using namespace std;
+
+namespace {
+
+/// Number of ids the direct map of ids to rows may always cover, regardless of the number of rows.
+constexpr std::size_t g_min_direct_ids = 64U;
+
+/// Number of rows from which the counters of a store are spread over shards.
+constexpr std::size_t g_min_sharded_rows = 1024U;
+
+/// Number of shards of counters of a large store.
+constexpr std::size_t g_num_counter_shards = 16U;
+
+/// Presence bitmask of a person that attends all of its clusters.
+constexpr std::uint8_t g_present_everywhere = (1U << NumOfClusterTypes()) - 1U;
+
+/// Presence bitmask on days off: only the household and the primary community.
+constexpr std::uint8_t g_present_days_off =
+    (1U << static_cast<unsigned int>(ClusterType::Household)) |
+    (1U << static_cast<unsigned int>(ClusterType::PrimaryCommunity));
+
+/// Presence bitmask on regular days: everything but the primary community.
+constexpr std::uint8_t g_present_regular_days =
+    g_present_everywhere & ~(1U << static_cast<unsigned int>(ClusterType::PrimaryCommunity));
+
+} // namespace
+
+template <class BehaviourPolicy, class BeliefPolicy>
+GenericPersonStore<BehaviourPolicy, BeliefPolicy>::GenericPersonStore()
+    : m_size(0U), m_adult_presence(g_present_everywhere), m_child_presence(g_present_everywhere),
+      m_counter_shards(nullptr), m_num_counter_shards(0U)
+{
+	ResizeCounters(1U);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+PersonIndex GenericPersonStore<BehaviourPolicy, BeliefPolicy>::AllocateRow(PersonId id)
+{
+	if (id == g_no_id) {
+		FATAL_ERROR("Person id " + to_string(id) + " is reserved.");
+	}
+	if (Find(id) != g_no_index) {
+		FATAL_ERROR("Person id " + to_string(id) + " is already in use.");
+	}
+
+	PersonIndex index;
+	if (!m_free_indices.empty()) {
+		index = m_free_indices.back();
+		m_free_indices.pop_back();
+	} else {
+		index = static_cast<PersonIndex>(m_ids.size());
+		m_ids.emplace_back(g_no_id);
+		m_ages.emplace_back(0.0f);
+		for (auto& ids : m_cluster_ids) {
+			ids.emplace_back(0U);
+		}
+		m_health_status.emplace_back(HealthStatus::Susceptible);
+		m_days_infected.emplace_back(0U);
+		m_fates.emplace_back(disease::Fate());
+		m_belief_data.emplace_back();
+		m_participants.emplace_back(false);
+		// Rows are not added while the counters are updated concurrently.
+		if (m_ids.size() == g_min_sharded_rows) {
+			ResizeCounters(g_num_counter_shards);
+		}
+	}
+
+	SetIndexOfId(id, index);
+	m_ids[index] = id;
+	m_size++;
+	// Rows that are not in use hold a susceptible person that is not counted.
+	AddToCounter(index, ToSizeType(HealthStatus::Susceptible), 1);
+	return index;
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::SetIndexOfId(PersonId id, PersonIndex index)
+{
+	if (id >= m_index_of_id.size() && index != g_no_index && id < 2 * m_ids.size() + g_min_direct_ids) {
+		// The id is in proportion to the number of rows: grow the direct map over it and over
+		// the room it already has, and move the ids it now covers out of the sparse map.
+		m_index_of_id.resize(id + 1, g_no_index);
+		m_index_of_id.resize(m_index_of_id.capacity(), g_no_index);
+		for (auto it = m_sparse_index_of_id.begin(); it != m_sparse_index_of_id.end();) {
+			if (it->first < m_index_of_id.size()) {
+				m_index_of_id[it->first] = it->second;
+				it = m_sparse_index_of_id.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	if (id < m_index_of_id.size()) {
+		m_index_of_id[id] = index;
+	} else if (index != g_no_index) {
+		m_sparse_index_of_id[id] = index;
+	} else {
+		m_sparse_index_of_id.erase(id);
+	}
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+PersonIndex GenericPersonStore<BehaviourPolicy, BeliefPolicy>::Emplace(
+    PersonId id, double age, unsigned int household_id, unsigned int school_id, unsigned int work_id,
+    unsigned int primary_community_id, unsigned int secondary_community_id, disease::Fate fate,
+    double risk_averseness)
+{
+	const auto index = AllocateRow(id);
+	m_ages[index] = static_cast<float>(age);
+	m_cluster_ids[ToSizeType(ClusterType::Household)][index] = household_id;
+	m_cluster_ids[ToSizeType(ClusterType::School)][index] = school_id;
+	m_cluster_ids[ToSizeType(ClusterType::Work)][index] = work_id;
+	m_cluster_ids[ToSizeType(ClusterType::PrimaryCommunity)][index] = primary_community_id;
+	m_cluster_ids[ToSizeType(ClusterType::SecondaryCommunity)][index] = secondary_community_id;
+	SetHealth(index, Health(fate));
+	m_belief_data[index] = BeliefData();
+	BeliefPolicy::Initialize(m_belief_data[index], risk_averseness);
+	CountAdoption(index, false);
+	m_participants[index] = false;
+	return index;
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+PersonIndex GenericPersonStore<BehaviourPolicy, BeliefPolicy>::EmplaceCopy(
+    const GenericPersonStore& other, PersonIndex other_index, PersonId id)
+{
+	const auto index = AllocateRow(id);
+	m_ages[index] = other.m_ages[other_index];
+	for (std::size_t i = 0; i < m_cluster_ids.size(); i++) {
+		m_cluster_ids[i][index] = other.m_cluster_ids[i][other_index];
+	}
+	SetHealth(index, other.GetHealth(other_index));
+	m_belief_data[index] = other.m_belief_data[other_index];
+	CountAdoption(index, false);
+	m_participants[index] = other.m_participants[other_index];
+	return index;
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::Reserve(std::size_t count)
+{
+	m_ids.reserve(count);
+	m_ages.reserve(count);
+	for (auto& ids : m_cluster_ids) {
+		ids.reserve(count);
+	}
+	m_health_status.reserve(count);
+	m_days_infected.reserve(count);
+	m_fates.reserve(count);
+	m_belief_data.reserve(count);
+	m_participants.reserve(count);
+	m_index_of_id.reserve(count);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::Erase(PersonIndex index)
+{
+	SetIndexOfId(m_ids[index], g_no_index);
+	m_ids[index] = g_no_id;
+	// Unused rows hold a susceptible person, so that column scans can skip the liveness check.
+	AddToCounter(index, ToSizeType(m_health_status[index]), -1);
+	if (BeliefPolicy::HasAdopted(m_belief_data[index])) {
+		AddToCounter(index, g_adopted_counter, -1);
+	}
+	m_health_status[index] = HealthStatus::Susceptible;
+	m_free_indices.push_back(index);
+	m_size--;
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::StoreHealth(PersonIndex index, const Health& health)
+{
+	const auto days_infected = static_cast<std::uint16_t>(health.GetDaysInfected());
+	SetHealthStatus(index, health.GetHealthStatus());
+	m_days_infected[index] = health.IsInfected()
+				     ? static_cast<std::uint16_t>(m_transitions.GetDay() - days_infected)
+				     : days_infected;
+	m_fates[index] = health.GetFate();
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::ScheduleNextTransition(PersonIndex index)
+{
+	if (!IsInfected(m_health_status[index])) {
+		return;
+	}
+
+	// Health::Update acts on the days at which the fate of the person says something happens.
+	const auto& fate = m_fates[index];
+	const auto days_infected = GetDaysInfected(index);
+	auto next = numeric_limits<unsigned int>::max();
+	for (auto day : {fate.start_infectiousness, fate.start_symptomatic, fate.end_infectiousness,
+			 fate.end_symptomatic}) {
+		if (day > days_infected && day < next) {
+			next = day;
+		}
+	}
+	if (next != numeric_limits<unsigned int>::max()) {
+		m_transitions.Schedule(m_transitions.GetDay() + next - days_infected, index);
+	}
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::StartInfection(PersonIndex index)
+{
+	auto health = GetHealth(index);
+	health.StartInfection();
+	SetHealth(index, health);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::StopInfection(PersonIndex index)
+{
+	auto health = GetHealth(index);
+	health.StopInfection();
+	SetHealth(index, health);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::UpdatePresence(bool is_work_off, bool is_school_off)
+{
+	m_adult_presence = is_work_off ? g_present_days_off : g_present_regular_days;
+	m_child_presence = is_work_off || is_school_off ? g_present_days_off : g_present_regular_days;
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::AdvanceDay(std::vector<PersonIndex>& infectiousness_changes)
+{
+	auto& due = m_transitions.Advance();
+
+	// A person may have been scheduled more than once, e.g. when infected in two clusters on
+	// the same day, but the health of a person may only be updated once a day.
+	sort(due.begin(), due.end());
+	due.erase(unique(due.begin(), due.end()), due.end());
+
+	for (const auto index : due) {
+		const auto status = m_health_status[index];
+		const auto days_infected = GetDaysInfected(index);
+		if (!IsInfected(status) || days_infected == 0) {
+			continue;
+		}
+
+		// Health::Update counts today before acting on it.
+		Health health(m_fates[index], status, days_infected - 1);
+		health.Update();
+		StoreHealth(index, health);
+		if (health.IsInfectious() != IsInfectious(status)) {
+			infectiousness_changes.emplace_back(index);
+		}
+		const bool had_adopted = BeliefPolicy::HasAdopted(m_belief_data[index]);
+		BeliefPolicy::Update(m_belief_data[index], health);
+		CountAdoption(index, had_adopted);
+		ScheduleNextTransition(index);
+	}
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+std::size_t GenericPersonStore<BehaviourPolicy, BeliefPolicy>::GetInfectedCount() const
+{
+	return GetSize() - GetStatusCount(HealthStatus::Susceptible) - GetStatusCount(HealthStatus::Immune);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+std::size_t GenericPersonStore<BehaviourPolicy, BeliefPolicy>::SumCounters(std::size_t counter) const
+{
+	std::int64_t total = 0;
+	for (std::size_t i = 0; i < m_num_counter_shards; i++) {
+		total += m_counter_shards[i].counters[counter].load(memory_order_relaxed);
+	}
+	return static_cast<std::size_t>(total);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::ResizeCounters(std::size_t num_shards)
+{
+	// Place the shards at the first cache line boundary of a buffer with a shard to spare.
+	std::size_t space = (num_shards + 1) * sizeof(CounterShard);
+	std::unique_ptr<unsigned char[]> storage(new unsigned char[space]);
+	void* start = storage.get();
+	void* aligned = align(alignof(CounterShard), num_shards * sizeof(CounterShard), start, space);
+	auto shards = static_cast<CounterShard*>(aligned);
+
+	// The totals are carried over to the first shard.
+	for (std::size_t i = 0; i < num_shards; i++) {
+		::new (static_cast<void*>(shards + i)) CounterShard;
+		for (std::size_t counter = 0; counter <= g_adopted_counter; counter++) {
+			const auto total = i == 0 && m_counter_shards != nullptr ? SumCounters(counter) : 0U;
+			shards[i].counters[counter].store(static_cast<std::int64_t>(total), memory_order_relaxed);
+		}
+	}
+	m_counter_shards = shards;
+	m_num_counter_shards = num_shards;
+	m_counter_storage.swap(storage);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+std::size_t GenericPersonStore<BehaviourPolicy, BeliefPolicy>::GetMemoryUsage() const
+{
+	std::size_t result = sizeof(*this);
+	result += m_ids.capacity() * sizeof(PersonId);
+	result += m_ages.capacity() * sizeof(float);
+	for (const auto& ids : m_cluster_ids) {
+		result += ids.capacity() * sizeof(unsigned int);
+	}
+	result += m_health_status.capacity() * sizeof(HealthStatus);
+	result += m_days_infected.capacity() * sizeof(std::uint16_t);
+	result += m_fates.capacity() * sizeof(disease::Fate);
+	result += m_belief_data.capacity() * sizeof(BeliefData);
+	result += m_participants.capacity() / 8;
+	result += m_index_of_id.capacity() * sizeof(PersonIndex);
+	result += m_sparse_index_of_id.size() * (sizeof(PersonId) + sizeof(PersonIndex) + 2 * sizeof(void*));
+	result += m_free_indices.capacity() * sizeof(PersonIndex);
+	result += m_transitions.GetMemoryUsage();
+	result += (m_num_counter_shards + 1) * sizeof(CounterShard);
+	return result;
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+template <typename T>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::FirstTouch(Column<T>& column, unsigned int num_threads)
+{
+	Column<T> fresh;
+	fresh.reserve(column.capacity());
+	fresh.resize(column.size());
+	util::parallel::parallel_for_chunks(
+	    0, column.size(), num_threads, [&column, &fresh](std::size_t begin, std::size_t end, unsigned int) {
+		    std::copy(column.begin() + begin, column.begin() + end, fresh.begin() + begin);
+	    });
+	column.swap(fresh);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+void GenericPersonStore<BehaviourPolicy, BeliefPolicy>::FirstTouch(unsigned int num_threads)
+{
+	FirstTouch(m_ids, num_threads);
+	FirstTouch(m_ages, num_threads);
+	for (auto& ids : m_cluster_ids) {
+		FirstTouch(ids, num_threads);
+	}
+	FirstTouch(m_health_status, num_threads);
+	FirstTouch(m_days_infected, num_threads);
+	FirstTouch(m_fates, num_threads);
+	FirstTouch(m_belief_data, num_threads);
+	FirstTouch(m_index_of_id, num_threads);
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+template <typename T>
+std::size_t GenericPersonStore<BehaviourPolicy, BeliefPolicy>::CountRemotePages(
+    const Column<T>& column, unsigned int num_threads)
+{
+	std::atomic<std::size_t> result(0U);
+	util::parallel::parallel_for_chunks(
+	    0, column.size(), num_threads, [&column, &result](std::size_t begin, std::size_t end, unsigned int) {
+		    const auto size = (end - begin) * sizeof(T);
+		    result += util::count_remote_pages(column.data() + begin, size, util::get_numa_node());
+	    });
+	return result;
+}
+
+template <class BehaviourPolicy, class BeliefPolicy>
+std::size_t GenericPersonStore<BehaviourPolicy, BeliefPolicy>::CountRemotePages(unsigned int num_threads) const
+{
+	std::size_t result = CountRemotePages(m_ids, num_threads) + CountRemotePages(m_ages, num_threads);
+	for (const auto& ids : m_cluster_ids) {
+		result += CountRemotePages(ids, num_threads);
+	}
+	result += CountRemotePages(m_health_status, num_threads);
+	result += CountRemotePages(m_days_infected, num_threads);
+	result += CountRemotePages(m_fates, num_threads);
+	result += CountRemotePages(m_belief_data, num_threads);
+	result += CountRemotePages(m_index_of_id, num_threads);
+	return result;
+}
+
+//--------------------------------------------------------------------------
+// All explicit instantiations.
+//--------------------------------------------------------------------------
+template class GenericPersonStore<NoBehaviour, NoBelief>;
+template class GenericPersonStore<AlwaysFollowBeliefs, Threshold<true, false>>;
+template class GenericPersonStore<AlwaysFollowBeliefs, Threshold<false, true>>;
+template class GenericPersonStore<AlwaysFollowBeliefs, Threshold<true, true>>;
+
+} // end_of_namespace
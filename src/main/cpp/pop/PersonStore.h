@@ -0,0 +1,353 @@
+#ifndef PERSON_STORE_H_INCLUDED
+#define PERSON_STORE_H_INCLUDED
+
+#include "Age.h"
+#include "core/ClusterType.h"
+#include "core/Disease.h"
+#include "core/Health.h"
+#include "util/DefaultInitAllocator.h"
+#include "util/TimingWheel.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "behaviour/behaviour_policies/AlwaysFollowBeliefs.h"
+#include "behaviour/behaviour_policies/NoBehaviour.h"
+
+#include "behaviour/belief_policies/NoBelief.h"
+#include "behaviour/belief_policies/Threshold.h"
+
+namespace stride {
+
+using PersonId = unsigned int;
+
+/// Dense index of a row in a person store.
+using PersonIndex = std::uint32_t;
+
+/**
+ * Columnar (struct-of-arrays) storage for person data. Each person occupies one row,
+ * every attribute lives in its own contiguous array. Rows of erased persons are
+ * recycled by later insertions; the indices of all other rows remain valid.
+ *
+ * The store keeps its own simulation day. Disease transitions are scheduled on the day they
+ * are due when an infection starts, so advancing a day only visits the persons whose health
+ * status changes on that day.
+ *
+ * The number of persons per health status and the number of persons that adopted the belief
+ * are kept up to date with every change, so reading them does not visit any person.
+ */
+template <class BehaviourPolicy, class BeliefPolicy>
+class GenericPersonStore
+{
+public:
+	using BeliefData = typename BeliefPolicy::Data;
+
+	/// Index value that does not refer to any row.
+	static constexpr PersonIndex g_no_index = std::numeric_limits<PersonIndex>::max();
+
+	/// Id value stored in rows that are not in use.
+	static constexpr PersonId g_no_id = std::numeric_limits<PersonId>::max();
+
+	/// Creates an empty store.
+	GenericPersonStore();
+
+	/// Adds a person and returns the index of its row.
+	PersonIndex Emplace(
+	    PersonId id, double age, unsigned int household_id, unsigned int school_id, unsigned int work_id,
+	    unsigned int primary_community_id, unsigned int secondary_community_id, disease::Fate fate,
+	    double risk_averseness = 0);
+
+	/// Copies a row of another store into this store and gives it the given id.
+	PersonIndex EmplaceCopy(const GenericPersonStore& other, PersonIndex other_index, PersonId id);
+
+	/// Reserves room for the given number of persons.
+	void Reserve(std::size_t count);
+
+	/// Removes the person at the given index from this store.
+	void Erase(PersonIndex index);
+
+	/// Get the index of the person with the given id, or g_no_index if there is no such person.
+	PersonIndex Find(PersonId id) const
+	{
+		return id < m_index_of_id.size() ? m_index_of_id[id] : FindSparse(id);
+	}
+
+	/// Get the number of rows, including the ones that are not in use.
+	std::size_t GetRowCount() const { return m_ids.size(); }
+
+	/// Get the number of persons in this store.
+	std::size_t GetSize() const { return m_size; }
+
+	/// Check whether the row at the given index holds a person.
+	bool IsLive(PersonIndex index) const { return m_ids[index] != g_no_id; }
+
+	/// Get the id of the person at the given index.
+	PersonId GetId(PersonIndex index) const { return m_ids[index]; }
+
+	/// Get the age of the person at the given index.
+	double GetAge(PersonIndex index) const { return m_ages[index]; }
+
+	/// Get the id of the cluster of the given type the person at the given index belongs to.
+	unsigned int GetClusterId(PersonIndex index, ClusterType cluster_type) const
+	{
+		return m_cluster_ids[ToSizeType(cluster_type)][index];
+	}
+
+	/// Check if the person at the given index is present today in a given cluster.
+	bool IsInCluster(PersonIndex index, ClusterType cluster_type) const
+	{
+		return IsPresentToday(IsChild(index), cluster_type);
+	}
+
+	/// Check if the person at the given index is a child, whose presence follows the school days.
+	bool IsChild(PersonIndex index) const { return m_ages[index] <= MinAdultAge(); }
+
+	/// Check if children or adults are present today in clusters of the given type.
+	bool IsPresentToday(bool is_child, ClusterType cluster_type) const
+	{
+		return ((is_child ? m_child_presence : m_adult_presence) >> ToSizeType(cluster_type)) & 1U;
+	}
+
+	/// Get a key that identifies today's presence in clusters; it only changes with the type of day.
+	std::uint16_t GetPresenceKey() const
+	{
+		return static_cast<std::uint16_t>((m_adult_presence << 8) | m_child_presence);
+	}
+
+	/// Get the health status of the person at the given index.
+	HealthStatus GetHealthStatus(PersonIndex index) const { return m_health_status[index]; }
+
+	/// Get the health of the person at the given index.
+	Health GetHealth(PersonIndex index) const
+	{
+		return Health(m_fates[index], m_health_status[index], GetDaysInfected(index));
+	}
+
+	/// Overwrite the health of the person at the given index.
+	void SetHealth(PersonIndex index, const Health& health)
+	{
+		StoreHealth(index, health);
+		ScheduleNextTransition(index);
+	}
+
+	/// Overwrite the fates of all rows with samples of the given disease; see Disease::SampleMany.
+	void SampleFates(const disease::Disease& disease, util::Random& rng, unsigned int num_threads)
+	{
+		disease.SampleMany(rng, m_fates.data(), m_fates.size(), num_threads);
+	}
+
+	/// Make the person at the given index immune.
+	void SetImmune(PersonIndex index) { SetHealthStatus(index, HealthStatus::Immune); }
+
+	/// Start the infection of the person at the given index.
+	void StartInfection(PersonIndex index);
+
+	/// Stop the infection of the person at the given index.
+	void StopInfection(PersonIndex index);
+
+	/// Get the belief data of the person at the given index.
+	const BeliefData& GetBeliefData(PersonIndex index) const { return m_belief_data[index]; }
+
+	/// Update the belief of the person at the given index upon meeting the given person.
+	template <typename TPerson>
+	void UpdateBelief(PersonIndex index, const TPerson& other)
+	{
+		const bool had_adopted = BeliefPolicy::HasAdopted(m_belief_data[index]);
+		BeliefPolicy::Update(m_belief_data[index], other);
+		CountAdoption(index, had_adopted);
+	}
+
+	/// Does the person at the given index participate in the social contact study?
+	bool IsParticipatingInSurvey(PersonIndex index) const { return m_participants[index]; }
+
+	/// Let the person at the given index participate in the social contact study.
+	void ParticipateInSurvey(PersonIndex index) { m_participants[index] = true; }
+
+	/// Sets the type of day, which determines the presence in clusters of every person. It is
+	/// the only way to change the presence, once a day for the whole store.
+	void UpdatePresence(bool is_work_off, bool is_school_off);
+
+	/// Moves on to the next day and carries out the disease transitions that are due. The
+	/// indices of the persons that became or stopped being infectious are appended to the
+	/// given vector.
+	void AdvanceDay(std::vector<PersonIndex>& infectiousness_changes);
+
+	/// Get the number of persons with the given health status.
+	std::size_t GetStatusCount(HealthStatus status) const { return SumCounters(ToSizeType(status)); }
+
+	/// Get the cumulative number of cases, i.e. the persons that are or have been infected.
+	std::size_t GetInfectedCount() const;
+
+	/// Get the number of persons that adopted the belief.
+	std::size_t GetAdoptedCount() const { return SumCounters(g_adopted_counter); }
+
+	/// Get the number of bytes allocated by this store.
+	std::size_t GetMemoryUsage() const;
+
+	/// Moves the data of the persons to fresh memory, where the rows of each chunk of
+	/// parallel_for_chunks with the given number of threads are written first by the thread that
+	/// runs the chunk. On a NUMA machine, that puts the rows on the node of that thread.
+	void FirstTouch(unsigned int num_threads);
+
+	/// Get the number of pages of person data that are on another NUMA node than the thread that
+	/// visits their rows in a parallel loop with the given number of threads.
+	std::size_t CountRemotePages(unsigned int num_threads) const;
+
+private:
+	/// Claims a row for a person with the given id.
+	PersonIndex AllocateRow(PersonId id);
+
+	/// Get the index of the person with an id beyond the direct map, or g_no_index if there is none.
+	PersonIndex FindSparse(PersonId id) const
+	{
+		const auto it = m_sparse_index_of_id.find(id);
+		return it == m_sparse_index_of_id.end() ? g_no_index : it->second;
+	}
+
+	/// Maps the given id to the given index, or to no row if the index is g_no_index.
+	void SetIndexOfId(PersonId id, PersonIndex index);
+
+	/// Get the number of days the person at the given index has been infected.
+	unsigned int GetDaysInfected(PersonIndex index) const
+	{
+		// Infected persons hold the day their infection started instead.
+		return IsInfected(m_health_status[index])
+			   ? static_cast<std::uint16_t>(m_transitions.GetDay() - m_days_infected[index])
+			   : m_days_infected[index];
+	}
+
+	/// Overwrite the health of the person at the given index, without scheduling transitions.
+	void StoreHealth(PersonIndex index, const Health& health);
+
+	/// Overwrite the health status of the person at the given index and count the change.
+	void SetHealthStatus(PersonIndex index, HealthStatus status)
+	{
+		AddToCounter(index, ToSizeType(m_health_status[index]), -1);
+		AddToCounter(index, ToSizeType(status), 1);
+		m_health_status[index] = status;
+	}
+
+	/// Counts a change of the adoption of the belief by the person at the given index.
+	void CountAdoption(PersonIndex index, bool had_adopted)
+	{
+		const bool has_adopted = BeliefPolicy::HasAdopted(m_belief_data[index]);
+		if (has_adopted != had_adopted) {
+			AddToCounter(index, g_adopted_counter, has_adopted ? 1 : -1);
+		}
+	}
+
+	/// Adds to a counter in the shard of the person at the given index.
+	void AddToCounter(PersonIndex index, std::size_t counter, std::int64_t value)
+	{
+		auto& shard = m_counter_shards[index & (m_num_counter_shards - 1)];
+		shard.counters[counter].fetch_add(value, std::memory_order_relaxed);
+	}
+
+	/// Sums a counter over all shards.
+	std::size_t SumCounters(std::size_t counter) const;
+
+	/// Moves the counters to the given number of shards, which is a power of two. This may not
+	/// run concurrently with updates of the counters.
+	void ResizeCounters(std::size_t num_shards);
+
+	/// Schedules the next disease transition of the person at the given index, if any.
+	void ScheduleNextTransition(PersonIndex index);
+
+private:
+	/// A column does not write the rows it grows by, so that FirstTouch can leave that to the threads.
+	template <typename T>
+	using Column = std::vector<T, util::DefaultInitAllocator<T>>;
+
+	/// Moves the given column to fresh memory that is written first by the threads that visit its rows.
+	template <typename T>
+	static void FirstTouch(Column<T>& column, unsigned int num_threads);
+
+	/// Counts the pages of the given column that are on another NUMA node than the threads that
+	/// visit their rows.
+	template <typename T>
+	static std::size_t CountRemotePages(const Column<T>& column, unsigned int num_threads);
+
+private:
+	Column<PersonId> m_ids;
+	Column<float> m_ages;
+	std::array<Column<unsigned int>, NumOfClusterTypes()> m_cluster_ids;
+
+	Column<HealthStatus> m_health_status;
+
+	/// Day the infection started for infected persons, number of days infected for others.
+	Column<std::uint16_t> m_days_infected;
+
+	Column<disease::Fate> m_fates;
+	Column<BeliefData> m_belief_data;
+	std::vector<bool> m_participants;
+
+	/// Maps person ids to row indices. It is only grown to ids that are in proportion to the number
+	/// of rows, so that a store with a few persons with large ids, such as the store of a single
+	/// person, does not take memory in proportion to those ids.
+	Column<PersonIndex> m_index_of_id;
+
+	/// Maps the ids beyond m_index_of_id to row indices.
+	std::unordered_map<PersonId, PersonIndex> m_sparse_index_of_id;
+
+	/// Rows that are not in use.
+	std::vector<PersonIndex> m_free_indices;
+
+	/// Number of rows in use.
+	std::size_t m_size;
+
+	/// Today's presence in clusters of adults and of children as a bitmask; bit i corresponds
+	/// to ClusterType i.
+	std::uint8_t m_adult_presence;
+	std::uint8_t m_child_presence;
+
+	/// Persons whose health status may change, by day. Health changes are not made concurrently:
+	/// the infector gathers transmissions in a buffer per thread and starts the infections after
+	/// the parallel sweep over the clusters.
+	util::TimingWheel<PersonIndex> m_transitions;
+
+	/// Position of the number of adopters in a shard of counters, after those of the health statuses.
+	static constexpr std::size_t g_adopted_counter = NumOfHealthStatuses();
+
+	/// Number of persons per health status and number of adopters, on a cache line of its own.
+	struct alignas(64) CounterShard
+	{
+		std::array<std::atomic<std::int64_t>, g_adopted_counter + 1> counters;
+	};
+
+	/// Persons are spread over shards of counters, so that concurrent updates seldom contend.
+	/// A store starts with a single shard, and only gets more of them once it is large enough
+	/// for concurrent updates, so that a store of a single person stays small.
+	CounterShard* m_counter_shards;
+
+	/// Number of shards of counters, a power of two.
+	std::size_t m_num_counter_shards;
+
+	/// The memory of the shards of counters; operator new does not align them to a cache line.
+	std::unique_ptr<unsigned char[]> m_counter_storage;
+};
+
+template <class BehaviourPolicy, class BeliefPolicy>
+constexpr PersonIndex GenericPersonStore<BehaviourPolicy, BeliefPolicy>::g_no_index;
+
+template <class BehaviourPolicy, class BeliefPolicy>
+constexpr PersonId GenericPersonStore<BehaviourPolicy, BeliefPolicy>::g_no_id;
+
+template <class BehaviourPolicy, class BeliefPolicy>
+constexpr std::size_t GenericPersonStore<BehaviourPolicy, BeliefPolicy>::g_adopted_counter;
+
+extern template class GenericPersonStore<NoBehaviour, NoBelief>;
+extern template class GenericPersonStore<AlwaysFollowBeliefs, Threshold<true, false>>;
+extern template class GenericPersonStore<AlwaysFollowBeliefs, Threshold<false, true>>;
+extern template class GenericPersonStore<AlwaysFollowBeliefs, Threshold<true, true>>;
+
+using PersonStore = GenericPersonStore<NoBehaviour, NoBelief>;
+
+} // end_of_namespace
+
+#endif // end of include guard
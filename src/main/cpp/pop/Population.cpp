@@ -1,10 +1,8 @@
 #include "Population.h"
 
-#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
-#include <numeric>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -12,8 +10,6 @@
 #include "Person.h"
 #include "core/Health.h"
 #include "util/Errors.h"
-#include "util/Parallel.h"
-#include "util/ParallelMap.h"
 #include "util/Random.h"
 
 namespace stride {
@@ -36,15 +32,24 @@ std::vector<Person> Population::get_random_persons(util::Random& rng, std::size_
 		random_pick_indices[pick_index] = i;
 	}
 
-	std::vector<Person> random_picks(count, Person(0, nullptr));
+	std::vector<PersonIndex> random_pick_rows(count);
 	std::size_t i = 0;
-	for (const auto& pair : people) {
-		if (random_pick_indices.find(i) != random_pick_indices.end()) {
-			random_picks[random_pick_indices[i]] = Person(pair.first, pair.second);
+	for (PersonIndex row = 0; row < people->GetRowCount(); row++) {
+		if (!people->IsLive(row)) {
+			continue;
+		}
+		auto pick = random_pick_indices.find(i);
+		if (pick != random_pick_indices.end()) {
+			random_pick_rows[pick->second] = row;
 		}
 		i++;
 	}
 
+	std::vector<Person> random_picks;
+	random_picks.reserve(count);
+	for (auto row : random_pick_rows) {
+		random_picks.emplace_back(people.get(), row);
+	}
 	return random_picks;
 }
 
@@ -100,17 +105,5 @@ std::vector<Person> Population::get_random_persons(
 }
 
 /// Get the cumulative number of cases.
-unsigned int Population::get_infected_count() const
-{
-	std::atomic<unsigned int> total(0u);
-	util::parallel::parallel_for(
-	    people, util::parallel::get_number_of_threads(),
-	    [&total](const PersonId&, const std::shared_ptr<PersonData>& data, unsigned int) {
-		    const auto& health = data->GetHealth();
-		    if (health.IsInfected() || health.IsRecovered()) {
-			    total++;
-		    }
-	    });
-	return total;
+unsigned int Population::get_infected_count() const { return static_cast<unsigned int>(people->GetInfectedCount()); }
 }
-}
\ No newline at end of file
@@ -5,13 +5,13 @@
 #include <map>
 #include <memory>
 #include <numeric>
+#include <utility>
 #include <vector>
 #include "Person.h"
 #include "core/Atlas.h"
 #include "core/Health.h"
 #include "geo/GeoPosition.h"
 #include "util/Parallel.h"
-#include "util/ParallelMap.h"
 #include "util/Random.h"
 
 namespace stride {
@@ -22,18 +22,18 @@ namespace stride {
 class Population
 {
 private:
-	util::parallel::ParallelMap<PersonId, std::shared_ptr<PersonData>> people;
+	std::unique_ptr<PersonStore> people;
 	PersonId max_person_id;
 	Atlas atlas;
 	bool has_atlas_flag;
 
 public:
 	/// Creates a population. No atlas is associated with the population.
-	Population() : has_atlas_flag(false) {}
+	Population() : people(new PersonStore()), max_person_id(0), has_atlas_flag(false) {}
 
 	/// Creates a population. The given Boolean specifies if the population
 	/// includes an atlas.
-	Population(bool has_atlas) : has_atlas_flag(has_atlas) {}
+	Population(bool has_atlas) : people(new PersonStore()), max_person_id(0), has_atlas_flag(has_atlas) {}
 
 	Population(const Population&) = delete;
 	Population& operator=(const Population&) = delete;
@@ -45,78 +45,95 @@ public:
 	class const_iterator final
 	{
 	public:
-		typedef decltype(people)::const_iterator map_iterator;
-
-		const_iterator(const map_iterator& map_iterator_val) : map_iterator_val(map_iterator_val) {}
+		const_iterator(PersonStore* store, PersonIndex index) : store(store), index(index) { SkipForward(); }
 		const_iterator(const const_iterator&) = default;
 		const_iterator& operator++()
 		{
-			++map_iterator_val;
+			++index;
+			SkipForward();
 			return *this;
 		}
 		const_iterator operator++(int)
 		{
 			auto result = *this;
-			map_iterator_val++;
+			++(*this);
 			return result;
 		}
 		const_iterator& operator--()
 		{
-			--map_iterator_val;
+			do {
+				--index;
+			} while (!store->IsLive(index));
 			return *this;
 		}
 		const_iterator operator--(int)
 		{
 			auto result = *this;
-			map_iterator_val--;
+			--(*this);
 			return result;
 		}
-		Person operator*() const { return Person(map_iterator_val->first, map_iterator_val->second); }
-		bool operator==(const const_iterator& other) const
-		{
-			return map_iterator_val == other.map_iterator_val;
-		}
-		bool operator!=(const const_iterator& other) const
-		{
-			return map_iterator_val != other.map_iterator_val;
-		}
+		Person operator*() const { return Person(store, index); }
+		bool operator==(const const_iterator& other) const { return index == other.index; }
+		bool operator!=(const const_iterator& other) const { return index != other.index; }
 
 		friend void swap(const_iterator& lhs, const_iterator& rhs);
 
 	private:
-		map_iterator map_iterator_val;
+		/// Moves this iterator to the next row that holds a person.
+		void SkipForward()
+		{
+			while (index < store->GetRowCount() && !store->IsLive(index)) {
+				++index;
+			}
+		}
+
+	private:
+		PersonStore* store;
+		PersonIndex index;
 	};
 
 	typedef const_iterator iterator;
 
-	/// Inserts a new element into the container constructed in-place with the given args.
+	/// Inserts a new person into the container, constructed in-place with the given args.
 	template <typename... TArgs>
-	const_iterator emplace(TArgs&&... args)
+	const_iterator emplace(PersonId id, TArgs&&... args)
 	{
-		Person value(args...);
-		if (value.GetId() > max_person_id)
-			max_person_id = value.GetId();
+		if (id > max_person_id)
+			max_person_id = id;
 
-		return const_iterator(people.emplace(value.GetId(), value.GetData()).first);
+		return const_iterator(people.get(), people->Emplace(id, std::forward<TArgs>(args)...));
+	}
+
+	/// Inserts a copy of the given person into the container.
+	const_iterator emplace(const Person& person)
+	{
+		if (person.GetId() > max_person_id)
+			max_person_id = person.GetId();
+
+		return const_iterator(
+		    people.get(), people->EmplaceCopy(*person.GetStore(), person.GetIndex(), person.GetId()));
 	}
 
 	/// Extracts the person with the given id from this population.
 	Person extract(PersonId id)
 	{
-		Person result(id, people.find(id)->second);
-		people.erase(id);
+		const auto index = people->Find(id);
+		Person result = Person(people.get(), index).Clone();
+		people->Erase(index);
 		return result;
 	}
 
 	/// Gets the person with the given id in this population.
-	Person getPerson(PersonId id) const
-	{
-		Person result(id, people.find(id)->second);
-		return result;
-	}
+	Person getPerson(PersonId id) const { return Person(people.get(), people->Find(id)); }
+
+	/// Gets the store that holds the data of the people in this population.
+	const PersonStore& get_store() const { return *people; }
+
+	/// Gets the store that holds the data of the people in this population.
+	PersonStore& get_store() { return *people; }
 
 	/// Gets the number of people in this population.
-	auto size() const -> decltype(people.size()) { return people.size(); }
+	std::size_t size() const { return people->GetSize(); }
 
 	/// Tests if this population uses an atlas.
 	bool has_atlas() const { return has_atlas_flag; }
@@ -128,10 +145,13 @@ public:
 	const Atlas& get_atlas() const { return atlas; }
 
 	/// Creates a constant iterator positioned at the first person in this population.
-	const_iterator begin() const { return const_iterator(people.begin()); }
+	const_iterator begin() const { return const_iterator(people.get(), 0); }
 
 	/// Creates a constant iterator positioned just past the last person in this population.
-	const_iterator end() const { return const_iterator(people.end()); }
+	const_iterator end() const
+	{
+		return const_iterator(people.get(), static_cast<PersonIndex>(people->GetRowCount()));
+	}
 
 	/// Gets the largest id for any person that has ever been in this population.
 	PersonId get_max_id() const { return max_person_id; }
@@ -150,19 +170,8 @@ public:
 	/// Get the fraction of the population that is infected.
 	double get_fraction_infected() const { return double(get_infected_count()) / size(); }
 
-	template <typename BeliefPolicy>
-	unsigned int get_adopted_count() const
-	{
-		unsigned int total{0U};
-		for (const auto& p : *this) {
-			auto belief_data = p.GetBeliefData();
-			bool adopted = BeliefPolicy::HasAdopted(belief_data);
-			if (adopted) {
-				total++;
-			}
-		}
-		return total;
-	}
+	/// Get the number of people that adopted the belief.
+	unsigned int get_adopted_count() const { return static_cast<unsigned int>(people->GetAdoptedCount()); }
 
 	/// Register the map of GeoPositions to Towns to the atlas.
 	void atlas_register_towns(const Atlas::TownMap& towns) { atlas.RegisterTowns(towns); }
@@ -182,14 +191,20 @@ public:
 
 	/// Runs the `action` on every element of this vector. Up to `number_of_threads` instances of
 	/// the `action` are run at the same time. `action` must be invocable with signature
-	/// `void(const Person& person, unsigned int thread_number)`.
+	/// `void(const Person& person, unsigned int thread_number)`. The rows are visited in the
+	/// chunks of parallel_for_chunks, like PersonStore::FirstTouch places them.
 	template <typename TAction>
 	void parallel_for(unsigned int number_of_threads, const TAction& action) const
 	{
-		stride::util::parallel::parallel_for(
-		    people, number_of_threads,
-		    [&action](const PersonId& id, const std::shared_ptr<PersonData>& data, unsigned int thread_number) {
-			    return action(Person(id, data), thread_number);
+		auto store = people.get();
+		stride::util::parallel::parallel_for_chunks(
+		    0, store->GetRowCount(), number_of_threads,
+		    [store, &action](std::size_t begin, std::size_t end, unsigned int thread_number) {
+			    for (std::size_t i = begin; i < end; i++) {
+				    if (store->IsLive(i)) {
+					    action(Person(store, i), thread_number);
+				    }
+			    }
 		    });
 	}
 
@@ -198,10 +213,12 @@ public:
 	template <typename TAction>
 	void serial_for(const TAction& action) const
 	{
-		stride::util::parallel::serial_for(
-		    people,
-		    [&action](const PersonId& id, const std::shared_ptr<PersonData>& data, unsigned int thread_number) {
-			    return action(Person(id, data), thread_number);
+		auto store = people.get();
+		stride::util::parallel::serial_for_range(
+		    0, store->GetRowCount(), [store, &action](std::size_t i, unsigned int thread_number) {
+			    if (store->IsLive(i)) {
+				    action(Person(store, i), thread_number);
+			    }
 		    });
 	}
 };
@@ -209,7 +226,8 @@ public:
 /// Swaps two population iterators.
 inline void swap(typename Population::const_iterator& lhs, typename Population::const_iterator& rhs)
 {
-	std::swap(lhs.map_iterator_val, rhs.map_iterator_val);
+	std::swap(lhs.store, rhs.store);
+	std::swap(lhs.index, rhs.index);
 }
 
 using PopulationRef = std::shared_ptr<const Population>;
@@ -8,10 +8,11 @@
 #include "pop/Model.h"
 #include "pop/Person.h"
 #include "pop/Population.h"
+#include "pop/PopulationFile.h"
 #include "util/Errors.h"
 #include "util/InstallDirs.h"
+#include "util/MappedFile.h"
 #include "util/Random.h"
-#include "util/StringUtils.h"
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
@@ -21,6 +22,8 @@
 #include <boost/property_tree/xml_parser.hpp>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -37,7 +40,7 @@ using namespace stride::util;
 
 shared_ptr<Population> PopulationBuilder::Build(
     const SingleSimulationConfig& config, const boost::property_tree::ptree& pt_disease, util::Random& rng,
-    const std::shared_ptr<spdlog::logger>& log)
+    const std::shared_ptr<spdlog::logger>& log, unsigned int num_threads)
 {
 	// Setup.
 	const auto pop = make_shared<Population>();
@@ -55,31 +58,26 @@ shared_ptr<Population> PopulationBuilder::Build(
 	}
 
 	// Add persons to population.
-	auto pop_file = InstallDirs::OpenDataFile(config.GetPopulationPath());
 	if (boost::algorithm::ends_with(config.GetPopulationPath(), ".csv")) {
-		// Read population data file.
-		string line;
-		getline(*pop_file, line); // step over file header
+		// Parse the population data file, then add the persons in a single pass.
+		const auto start = chrono::steady_clock::now();
+		const MappedFile pop_file(InstallDirs::GetDataDir() / config.GetPopulationPath());
+		const auto records = PopulationFile::ParseCsv(pop_file.GetData(), pop_file.GetSize(), num_threads);
+		const chrono::duration<double> parse_time = chrono::steady_clock::now() - start;
+		cout << "Parsed population file at " << pop_file.GetSize() / 1e6 / max(parse_time.count(), 1e-9)
+		     << " MB/s" << endl;
+
+		population.get_store().Reserve(records.size());
 		unsigned int person_id = 0U;
-		while (getline(*pop_file, line)) {
-			const auto values = StringUtils::Split(line, ",");
-			const auto risk_averseness =
-			    values.size() > 6 ? StringUtils::FromString<double>(values[6]) : 0.0;
+		for (const auto& record : records) {
 			population.emplace(
-			    person_id,
-			    StringUtils::FromString<unsigned int>(values[0]), // age
-			    StringUtils::FromString<unsigned int>(values[1]), // household_id
-			    StringUtils::FromString<unsigned int>(values[2]), // school_id
-			    StringUtils::FromString<unsigned int>(values[3]), // work_id
-			    StringUtils::FromString<unsigned int>(values[4]), // primary_community_id
-			    StringUtils::FromString<unsigned int>(values[5]), // secondary_community_id
-			    disease->Sample(rng),			      // Fate
-			    risk_averseness);				      // risk_averseness
-			++person_id;
+			    person_id++, record.age, record.household_id, record.school_id, record.work_id,
+			    record.primary_community_id, record.secondary_community_id, Fate(), record.risk_averseness);
 		}
+		population.get_store().SampleFates(*disease, rng, num_threads);
 	} else if (boost::algorithm::ends_with(config.GetPopulationPath(), ".xml")) {
 		auto generator = population::Generator::FromConfig(config, *disease, rng);
-		population = generator->Generate();
+		population = generator->Generate(num_threads);
 		if (!generator->FitsModel(population)) {
 			FATAL_ERROR("Generated population doesn't fit model " + config.GetPopulationPath());
 		}
@@ -110,13 +108,13 @@ shared_ptr<Population> PopulationBuilder::Build(
 	unsigned int num_immune = floor(static_cast<double>(population.size()) * immunity_rate);
 	auto is_susceptible = [](const Person& p) -> bool { return p.GetHealth().IsSusceptible(); };
 	for (auto& pers : population.get_random_persons(rng, num_immune, is_susceptible)) {
-		pers.GetHealth().SetImmune();
+		pers.SetImmune();
 	}
 
 	// Seed infected persons.
 	unsigned int num_infected = floor(static_cast<double>(population.size()) * seeding_rate);
 	for (auto& pers : population.get_random_persons(rng, num_infected, is_susceptible)) {
-		pers.GetHealth().StartInfection();
+		pers.StartInfection();
 	}
 
 	// Done
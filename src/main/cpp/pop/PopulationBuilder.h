@@ -25,11 +25,12 @@ public:
 	 * @param config          Single simulation configuration information.
 	 * @param pt_disease      Property_tree with disease configuration settings.
 	 * @param log             The contact log.
+	 * @param num_threads     The number of threads to generate a population with.
 	 * @return                Pointer to the initialized population.
 	 */
 	static std::shared_ptr<Population> Build(
 	    const SingleSimulationConfig& config, const boost::property_tree::ptree& pt_disease, util::Random& rng,
-	    const std::shared_ptr<spdlog::logger>& log);
+	    const std::shared_ptr<spdlog::logger>& log, unsigned int num_threads = 1U);
 };
 
 } // end_of_namespace
@@ -0,0 +1,205 @@
+#include "PopulationFile.h"
+
+#include "util/Errors.h"
+#include "util/Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace stride {
+
+namespace {
+
+/// Size in bytes of the blocks the file is cut into; the blocks do not depend on the number of threads.
+const std::size_t g_block_size = 1U << 20;
+
+/// Exactly representable powers of ten.
+const double g_powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+				  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+/// Skips the blanks and quotes in front of a field.
+void SkipPadding(const char*& p, const char* end)
+{
+	while (p != end && (*p == ' ' || *p == '\t' || *p == '"')) {
+		p++;
+	}
+}
+
+/// Parses the unsigned integer at the start of a field. As with reading it from a stream, what follows
+/// the digits is not parsed. Returns false if the field does not start with a digit.
+bool ParseUnsigned(const char*& p, const char* end, unsigned int& value)
+{
+	SkipPadding(p, end);
+	if (p == end || !IsDigit(*p)) {
+		return false;
+	}
+	unsigned int result = 0U;
+	for (; p != end && IsDigit(*p); p++) {
+		result = result * 10U + static_cast<unsigned int>(*p - '0');
+	}
+	value = result;
+	return true;
+}
+
+/// Parses the decimal number at the start of a field. Returns false if the field does not start with one.
+bool ParseDouble(const char*& p, const char* end, double& value)
+{
+	SkipPadding(p, end);
+	bool negative = false;
+	if (p != end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		p++;
+	}
+
+	// Gather the significant digits in an integer; digits beyond what it can hold only shift the exponent.
+	const std::uint64_t max_mantissa = 100000000000000000ULL;
+	std::uint64_t mantissa = 0U;
+	int exponent = 0;
+	bool has_digits = false;
+	for (; p != end && IsDigit(*p); p++) {
+		has_digits = true;
+		if (mantissa < max_mantissa) {
+			mantissa = mantissa * 10U + static_cast<std::uint64_t>(*p - '0');
+		} else {
+			exponent++;
+		}
+	}
+	if (p != end && *p == '.') {
+		for (p++; p != end && IsDigit(*p); p++) {
+			has_digits = true;
+			if (mantissa < max_mantissa) {
+				mantissa = mantissa * 10U + static_cast<std::uint64_t>(*p - '0');
+				exponent--;
+			}
+		}
+	}
+	if (!has_digits) {
+		return false;
+	}
+	if (p != end && (*p == 'e' || *p == 'E')) {
+		const char* q = p + 1;
+		bool negative_exponent = false;
+		if (q != end && (*q == '-' || *q == '+')) {
+			negative_exponent = *q == '-';
+			q++;
+		}
+		if (q != end && IsDigit(*q)) {
+			int e = 0;
+			for (; q != end && IsDigit(*q); q++) {
+				e = std::min(e * 10 + (*q - '0'), 10000);
+			}
+			exponent += negative_exponent ? -e : e;
+			p = q;
+		}
+	}
+
+	// Scaling by an exact power of ten rounds once, like a correctly rounded conversion.
+	double result = static_cast<double>(mantissa);
+	if (exponent < 0 && exponent >= -22) {
+		result /= g_powers_of_ten[-exponent];
+	} else if (exponent > 0 && exponent <= 22) {
+		result *= g_powers_of_ten[exponent];
+	} else if (exponent != 0) {
+		result *= std::pow(10.0, exponent);
+	}
+	value = negative ? -result : result;
+	return true;
+}
+
+/// Parses a line, without its line ending. Returns false if the line is malformed.
+bool ParseLine(const char* p, const char* end, PersonRecord& record)
+{
+	unsigned int* const fields[] = {&record.age,	 &record.household_id,		&record.school_id,
+					&record.work_id, &record.primary_community_id, &record.secondary_community_id};
+	for (std::size_t i = 0; i < 6; i++) {
+		if (i > 0) {
+			if (p == end) {
+				return false;
+			}
+			p++; // Step over the comma.
+		}
+		if (!ParseUnsigned(p, end, *fields[i])) {
+			return false;
+		}
+		p = std::find(p, end, ',');
+	}
+
+	record.risk_averseness = 0.0;
+	if (p != end) {
+		p++;
+		if (!ParseDouble(p, end, record.risk_averseness)) {
+			record.risk_averseness = 0.0;
+		}
+	}
+	return true;
+}
+
+} // namespace
+
+std::vector<PersonRecord> PopulationFile::ParseCsv(const char* data, std::size_t size, unsigned int num_threads)
+{
+	// Step over the header line.
+	const char* const end = data + size;
+	const char* const header_end = std::find(data, end, '\n');
+	const char* const body = header_end == end ? end : header_end + 1;
+
+	// Gets the start of the first line that starts at or after the given position.
+	const auto line_start = [body, end](const char* position) {
+		if (position <= body) {
+			return body;
+		}
+		if (position >= end) {
+			return end;
+		}
+		const char* const newline = std::find(position - 1, end, '\n');
+		return newline == end ? end : newline + 1;
+	};
+
+	// Every block parses the lines that start in it.
+	const std::size_t body_size = static_cast<std::size_t>(end - body);
+	const std::size_t num_blocks = (body_size + g_block_size - 1) / g_block_size;
+	std::vector<std::vector<PersonRecord>> blocks(num_blocks);
+	std::atomic<bool> malformed(false);
+	util::parallel::parallel_for_dynamic(0U, num_blocks, num_threads, [&](std::size_t block, unsigned int) {
+		const char* p = line_start(body + block * g_block_size);
+		const char* const block_end = line_start(body + std::min(body_size, (block + 1) * g_block_size));
+		auto& records = blocks[block];
+		records.reserve(static_cast<std::size_t>(block_end - p) / 16U);
+		while (p < block_end) {
+			const char* const line_end = std::find(p, block_end, '\n');
+			const char* content_end = line_end;
+			if (content_end != p && content_end[-1] == '\r') {
+				content_end--;
+			}
+			if (content_end != p) {
+				PersonRecord record;
+				if (ParseLine(p, content_end, record)) {
+					records.push_back(record);
+				} else {
+					malformed = true;
+				}
+			}
+			p = line_end == block_end ? block_end : line_end + 1;
+		}
+	});
+	if (malformed) {
+		FATAL_ERROR("Malformed line in population file.");
+	}
+
+	std::size_t num_records = 0U;
+	for (const auto& records : blocks) {
+		num_records += records.size();
+	}
+	std::vector<PersonRecord> result;
+	result.reserve(num_records);
+	for (const auto& records : blocks) {
+		result.insert(result.end(), records.begin(), records.end());
+	}
+	return result;
+}
+
+} // end_of_namespace
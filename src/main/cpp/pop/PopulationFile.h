@@ -0,0 +1,43 @@
+#ifndef POPULATION_FILE_H_INCLUDED
+#define POPULATION_FILE_H_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+namespace stride {
+
+/// The data of a person in a population data file.
+struct PersonRecord
+{
+	unsigned int age;
+	unsigned int household_id;
+	unsigned int school_id;
+	unsigned int work_id;
+	unsigned int primary_community_id;
+	unsigned int secondary_community_id;
+	double risk_averseness;
+};
+
+/**
+ * Parses population data files: CSV files with a header line and a line per person, with the age,
+ * household_id, school_id, work_id, primary_community and secondary_community of the person, and
+ * optionally its risk averseness.
+ */
+class PopulationFile
+{
+public:
+	/**
+	 * Parses the contents of a population data file. The contents are cut into blocks of whole
+	 * lines, which are parsed in parallel without allocating per line or per field.
+	 *
+	 * @param data            The contents of the file.
+	 * @param size            The size of the contents in bytes.
+	 * @param num_threads     The number of threads to parse with.
+	 * @return                The persons, in the order of the file.
+	 */
+	static std::vector<PersonRecord> ParseCsv(const char* data, std::size_t size, unsigned int num_threads);
+};
+
+} // end_of_namespace
+
+#endif // include guard
@@ -13,7 +13,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include "calendar/Calendar.h"
+#include "core/ClusterType.h"
 #include "core/LogMode.h"
+#include "core/TransmissionKernel.h"
 #include "multiregion/TravelModel.h"
 #include "util/Errors.h"
 #include "util/InstallDirs.h"
@@ -23,10 +25,22 @@ using namespace stride::util;
 
 namespace stride {
 
+namespace {
+/// Size from which a cluster takes longer to process than a typical thread's share of the other clusters.
+const unsigned int g_default_split_cluster_size = 4096U;
+
+/// Size from which the mean field kernel is used, for cluster types that are configured with it.
+const unsigned int g_default_mean_field_cluster_size = 1000U;
+}
+
 CommonSimulationConfig::CommonSimulationConfig()
     : track_index_case(false), rng_seed(), r0(), seeding_rate(), immunity_rate(), number_of_days(),
-      disease_config_file_name(), number_of_survey_participants(), initial_calendar(), contact_matrix_file_name()
+      disease_config_file_name(), number_of_survey_participants(), initial_calendar(), contact_matrix_file_name(),
+      split_cluster_size(g_default_split_cluster_size), mean_field_cluster_size(g_default_mean_field_cluster_size),
+      numa_aware(false)
 {
+	transmission_kernels.fill(TransmissionKernel::Pairwise);
+	small_cluster_kernels.fill(TransmissionKernel::Pairwise);
 }
 
 void CommonSimulationConfig::Parse(const boost::property_tree::ptree& pt)
@@ -45,6 +59,41 @@ void CommonSimulationConfig::Parse(const boost::property_tree::ptree& pt)
 	initial_calendar.Initialize(start_date, file_name);
 
 	contact_matrix_file_name = pt.get<std::string>("age_contact_matrix_file", "contact_matrix.xml");
+
+	// The mean field kernel falls back to the kernel in the fallback attribute, e.g.
+	// <work fallback="SkipSampling">MeanField</work>, or to the pairwise kernel.
+	transmission_kernels.fill(TransmissionKernel::Pairwise);
+	small_cluster_kernels.fill(TransmissionKernel::Pairwise);
+	if (const auto pt_kernels = pt.get_child_optional("transmission_kernel")) {
+		for (const auto& item : *pt_kernels) {
+			const auto cluster_type = ToClusterType(item.first);
+			if (cluster_type == ClusterType::Null) {
+				throw std::runtime_error(
+				    std::string(__func__) + "> Invalid cluster type " + item.first);
+			}
+			const auto kernel = ToTransmissionKernel(item.second.get_value<std::string>());
+			if (kernel == TransmissionKernel::Null) {
+				throw std::runtime_error(
+				    std::string(__func__) + "> Invalid input for TransmissionKernel.");
+			}
+			auto small_cluster_kernel = kernel;
+			if (kernel == TransmissionKernel::MeanField) {
+				const auto fallback = ToString(TransmissionKernel::Pairwise);
+				small_cluster_kernel =
+				    ToTransmissionKernel(item.second.get<std::string>("<xmlattr>.fallback", fallback));
+				if (small_cluster_kernel == TransmissionKernel::Null ||
+				    small_cluster_kernel == TransmissionKernel::MeanField) {
+					throw std::runtime_error(
+					    std::string(__func__) + "> Invalid fallback for the MeanField kernel.");
+				}
+			}
+			transmission_kernels[ToSizeType(cluster_type)] = kernel;
+			small_cluster_kernels[ToSizeType(cluster_type)] = small_cluster_kernel;
+		}
+	}
+	split_cluster_size = pt.get<unsigned int>("split_cluster_size", g_default_split_cluster_size);
+	mean_field_cluster_size = pt.get<unsigned int>("mean_field_cluster_size", g_default_mean_field_cluster_size);
+	numa_aware = pt.get<bool>("numa_aware", false);
 }
 
 LogConfig::LogConfig() : output_prefix(), generate_person_file(), log_level() {}
@@ -6,12 +6,15 @@
  * Configuration data structures for the simulator built, with multi-region in mind.
  */
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
 #include <boost/property_tree/ptree.hpp>
 #include "calendar/Calendar.h"
+#include "core/ClusterType.h"
 #include "core/LogMode.h"
+#include "core/TransmissionKernel.h"
 #include "multiregion/TravelModel.h"
 
 namespace stride {
@@ -60,6 +63,24 @@ struct CommonSimulationConfig final
 	/// The amount of days between 2 checkpoints. The first and last will be saved regardless.
 	unsigned int checkpoint_interval;
 
+	/// The transmission kernel for each cluster type.
+	std::array<TransmissionKernel, NumOfClusterTypes()> transmission_kernels;
+
+	/// The transmission kernel for each cluster type in clusters below mean_field_cluster_size. For the types
+	/// with the mean field kernel, this is the kernel it falls back to, otherwise it is their own kernel.
+	std::array<TransmissionKernel, NumOfClusterTypes()> small_cluster_kernels;
+
+	/// Clusters with at least this many members are divided over the threads; 0 disables this.
+	unsigned int split_cluster_size;
+
+	/// Clusters of a type with the mean field kernel only use it from this many members on; smaller
+	/// ones use the kernel in small_cluster_kernels.
+	unsigned int mean_field_cluster_size;
+
+	/// Whether the threads are pinned to CPUs and the person and cluster data is placed on the NUMA
+	/// nodes of the threads that visit it. Only OpenMP and the STL pool can pin threads.
+	bool numa_aware;
+
 	/// Fills this configuration with data from the given ptree.
 	void Parse(const boost::property_tree::ptree& pt);
 };
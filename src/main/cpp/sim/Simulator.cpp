@@ -9,9 +9,12 @@
 #include "core/LogMode.h"
 #include "multiregion/Visitor.h"
 #include "pop/Population.h"
+#include "util/Numa.h"
 #include "util/Parallel.h"
 
+#include <algorithm>
 #include <memory>
+#include <type_traits>
 #include <boost/property_tree/ptree.hpp>
 #include <spdlog/spdlog.h>
 
@@ -21,9 +24,21 @@ using namespace std;
 using namespace boost::property_tree;
 using namespace stride::util;
 
+std::vector<Cluster>& ClusterStruct::Get(ClusterType cluster_type)
+{
+	switch (cluster_type) {
+	case ClusterType::Household: return m_households;
+	case ClusterType::School: return m_school_clusters;
+	case ClusterType::Work: return m_work_clusters;
+	case ClusterType::PrimaryCommunity: return m_primary_community;
+	case ClusterType::SecondaryCommunity: return m_secondary_community;
+	default: throw runtime_error(std::string(__func__) + "> Invalid cluster type.");
+	}
+}
+
 Simulator::Simulator()
-    : m_config(), m_num_threads(1U), m_log_level(LogMode::Null), m_population(nullptr), m_disease_profile(),
-      m_track_index_case(false)
+    : m_config(), m_num_threads(1U), m_log_level(LogMode::Null), m_population(nullptr), m_active_clusters_stale(true),
+      m_disease_profile(), m_track_index_case(false)
 {
 }
 
@@ -32,18 +47,112 @@ void Simulator::SetTrackIndexCase(bool track_index_case) { m_track_index_case =
 template <LogMode log_level, bool track_index_case, typename local_information_policy>
 void Simulator::UpdateClusters()
 {
+	using TInfector = Infector<log_level, track_index_case, local_information_policy>;
 	auto log = m_log;
+	const auto kernels = m_config.common_config->transmission_kernels;
+	const auto small_cluster_kernels = m_config.common_config->small_cluster_kernels;
+	const auto mean_field_size = m_config.common_config->mean_field_cluster_size;
+	auto kernel_for = [&kernels, &small_cluster_kernels, mean_field_size](const Cluster& cluster) {
+		const auto type = ToSizeType(cluster.GetClusterType());
+		return cluster.GetSize() < mean_field_size ? small_cluster_kernels[type] : kernels[type];
+	};
 
-	auto action = [this, log](Cluster& cluster, unsigned int thread_id) {
-		Infector<log_level, track_index_case, local_information_policy>::Execute(
-		    cluster, m_disease_profile, m_rng_handler[thread_id], m_calendar, log);
+	// Draws are keyed by the day and the cluster, and infections only start once every cluster has
+	// been visited, so the outcome does not depend on the number of threads or the schedule.
+	for (auto& rng_handler : m_rng_handler) {
+		rng_handler.SetDay(m_calendar->GetSimulationDay());
+	}
+	m_transmissions.resize(m_num_threads);
+	for (auto& transmissions : m_transmissions) {
+		transmissions.clear();
+	}
+	m_contact_probabilities.SetTransmissionRate(m_disease_profile.GetTransmissionRate());
+
+	auto action = [this, log, &kernel_for](Cluster& cluster, unsigned int thread_id) {
+		TInfector::Execute(
+		    cluster, m_disease_profile, m_rng_handler[thread_id], m_transmissions[thread_id], m_calendar, log,
+		    kernel_for(cluster));
 	};
 
-	stride::util::parallel::parallel_for(m_clusters.m_households, m_num_threads, action);
-	stride::util::parallel::parallel_for(m_clusters.m_school_clusters, m_num_threads, action);
-	stride::util::parallel::parallel_for(m_clusters.m_work_clusters, m_num_threads, action);
-	stride::util::parallel::parallel_for(m_clusters.m_primary_community, m_num_threads, action);
-	stride::util::parallel::parallel_for(m_clusters.m_secondary_community, m_num_threads, action);
+	// Contacts are logged and information is exchanged in every cluster, otherwise only
+	// clusters with infectious members have anything to do.
+	const bool visit_all =
+	    log_level == LogMode::Contacts || !is_same<local_information_policy, NoLocalInformation>::value;
+	if (visit_all) {
+		// There is no order to gain from when every cluster is visited: a static schedule per type.
+		// Persons exchange beliefs when they meet, and a person is in clusters of several types, so
+		// with local information the clusters are visited in a fixed order by a single thread.
+		const bool exchange = !is_same<local_information_policy, NoLocalInformation>::value;
+		for (std::size_t type = 0; type < NumOfClusterTypes(); type++) {
+			auto& clusters = m_clusters.Get(static_cast<ClusterType>(type));
+			for (auto& cluster : clusters) {
+				cluster.UpdateContactProbabilities(m_contact_probabilities);
+				if (exchange) {
+					action(cluster, 0U);
+				}
+			}
+			if (!exchange) {
+				stride::util::parallel::parallel_for(clusters, m_num_threads, action);
+			}
+		}
+	} else {
+		SweepActiveClusters<TInfector>(kernel_for, action);
+	}
+
+	auto& transmissions = m_transmissions[0];
+	for (std::size_t i = 1; i < m_transmissions.size(); i++) {
+		transmissions.insert(transmissions.end(), m_transmissions[i].begin(), m_transmissions[i].end());
+	}
+	auto& store = m_population->get_store();
+	TInfector::StartInfections(store, transmissions, m_calendar, log);
+
+	// The clusters keep their members partitioned by health status.
+	for (const auto& transmission : transmissions) {
+		UpdateMemberStatus(Person(&store, transmission.infected));
+	}
+}
+
+template <typename TInfector, typename TKernelFor, typename TAction>
+void Simulator::SweepActiveClusters(const TKernelFor& kernel_for, const TAction& action)
+{
+	// All clusters of all types go into a single sweep, the most expensive ones first, so that
+	// no thread is left with a large cluster at the end and there is no barrier between types.
+	// The cost is estimated by the number of contacts between infectious and susceptible members.
+	// Clusters that are too large for a single thread are divided over all threads instead, unless
+	// the mean field kernel makes them take a single pass over their members.
+	const auto split_size = m_num_threads > 1 ? m_config.common_config->split_cluster_size : 0U;
+	m_cluster_sweep.clear();
+	m_split_clusters.clear();
+	for (std::size_t type = 0; type < NumOfClusterTypes(); type++) {
+		auto& clusters = m_clusters.Get(static_cast<ClusterType>(type));
+		for (const auto id : m_active_clusters[type]) {
+			auto& cluster = clusters[id];
+			cluster.UpdateContactProbabilities(m_contact_probabilities);
+			if (kernel_for(cluster) == TransmissionKernel::MeanField) {
+				m_cluster_sweep.emplace_back(cluster.GetSize(), &cluster);
+			} else if (split_size > 0 && cluster.GetSize() >= split_size) {
+				m_split_clusters.emplace_back(&cluster);
+			} else {
+				const auto cost = cluster.GetInfectiousCount() * cluster.GetSusceptibleCount();
+				m_cluster_sweep.emplace_back(cost, &cluster);
+			}
+		}
+	}
+	// Stable, so that the clusters are always visited in the same order.
+	stable_sort(m_cluster_sweep.begin(), m_cluster_sweep.end(),
+		    [](const pair<size_t, Cluster*>& a, const pair<size_t, Cluster*>& b) { return a.first > b.first; });
+
+	auto log = m_log;
+	for (auto cluster : m_split_clusters) {
+		TInfector::ExecuteSplit(
+		    *cluster, m_disease_profile, m_rng_handler, m_transmissions, m_num_threads, m_calendar, log,
+		    kernel_for(*cluster));
+	}
+
+	auto sweep_action = [this, &action](std::size_t i, unsigned int thread_id) {
+		action(*m_cluster_sweep[i].second, thread_id);
+	};
+	stride::util::parallel::parallel_for_dynamic(0, m_cluster_sweep.size(), m_num_threads, sweep_action);
 }
 
 void Simulator::AddPersonToClusters(const Person& person)
@@ -69,6 +178,9 @@ void Simulator::AddPersonToClusters(const Person& person)
 	if (secCom_id > 0) {
 		m_clusters.m_secondary_community[secCom_id].AddPerson(person);
 	}
+	if (person.GetHealth().IsInfectious()) {
+		ActivateClusters(person);
+	}
 }
 
 void Simulator::RemovePersonFromClusters(const Person& person)
@@ -96,6 +208,85 @@ void Simulator::RemovePersonFromClusters(const Person& person)
 	}
 }
 
+void Simulator::ActivateClusters(const Person& person)
+{
+	for (std::size_t type = 0; type < NumOfClusterTypes(); type++) {
+		// Cluster id '0' means "not present in any cluster of that type".
+		const auto cluster_id = person.GetClusterId(static_cast<ClusterType>(type));
+		if (cluster_id == 0) {
+			continue;
+		}
+		auto& is_active = m_is_active_cluster[type];
+		if (cluster_id >= is_active.size()) {
+			is_active.resize(m_clusters.Get(static_cast<ClusterType>(type)).size(), false);
+		}
+		if (!is_active[cluster_id]) {
+			is_active[cluster_id] = true;
+			m_active_clusters[type].emplace_back(cluster_id);
+		}
+	}
+}
+
+void Simulator::UpdateMemberStatus(const Person& person)
+{
+	for (std::size_t type = 0; type < NumOfClusterTypes(); type++) {
+		const auto cluster_type = static_cast<ClusterType>(type);
+		const auto cluster_id = person.GetClusterId(cluster_type);
+		if (cluster_id > 0) {
+			m_clusters.Get(cluster_type)[cluster_id].UpdateMemberStatus(person.GetIndex());
+		}
+	}
+}
+
+void Simulator::UpdateActiveClusters()
+{
+	auto& store = m_population->get_store();
+	for (const auto index : m_infectiousness_changes) {
+		const Person person(&store, index);
+		const bool is_infectious = IsInfectious(store.GetHealthStatus(index));
+		for (std::size_t type = 0; type < NumOfClusterTypes(); type++) {
+			const auto cluster_type = static_cast<ClusterType>(type);
+			const auto cluster_id = person.GetClusterId(cluster_type);
+			if (cluster_id > 0) {
+				m_clusters.Get(cluster_type)[cluster_id].UpdateInfectiousCount(is_infectious);
+			}
+		}
+		if (is_infectious) {
+			ActivateClusters(person);
+		}
+	}
+
+	for (std::size_t type = 0; type < NumOfClusterTypes(); type++) {
+		const auto& clusters = m_clusters.Get(static_cast<ClusterType>(type));
+		auto& active_clusters = m_active_clusters[type];
+		auto& is_active = m_is_active_cluster[type];
+		if (m_active_clusters_stale) {
+			// The clusters were (re)loaded: list all clusters with infectious members.
+			active_clusters.clear();
+			is_active.assign(clusters.size(), false);
+			for (std::size_t cluster_id = 1; cluster_id < clusters.size(); cluster_id++) {
+				if (clusters[cluster_id].GetInfectiousCount() > 0) {
+					is_active[cluster_id] = true;
+					active_clusters.emplace_back(cluster_id);
+				}
+			}
+		} else {
+			// Drop the clusters whose last infectious member recovered or left.
+			auto is_inactive = [&clusters, &is_active](ClusterId cluster_id) {
+				if (clusters[cluster_id].GetInfectiousCount() == 0) {
+					is_active[cluster_id] = false;
+					return true;
+				}
+				return false;
+			};
+			const auto new_end = remove_if(active_clusters.begin(), active_clusters.end(), is_inactive);
+			active_clusters.erase(new_end, active_clusters.end());
+			sort(active_clusters.begin(), active_clusters.end());
+		}
+	}
+	m_active_clusters_stale = false;
+}
+
 PersonId Simulator::GeneratePersonId()
 {
 	if (m_unused_person_ids.empty()) {
@@ -132,7 +323,7 @@ void Simulator::AcceptVisitors(const multiregion::SimulationStepInput& input)
 		    *m_population->emplace(m_expatriates.ExtractExpatriate(returning_expat.GetId()));
 
 		// Update the expatriate's stats.
-		home_expat.GetHealth() = returning_expat.GetHealth();
+		home_expat.SetHealth(returning_expat.GetHealth());
 		if (returning_expat.IsParticipatingInSurvey()) {
 			home_expat.ParticipateInSurvey();
 		}
@@ -155,7 +346,7 @@ void Simulator::AcceptVisitors(const multiregion::SimulationStepInput& input)
 		    disease::Fate());
 
 		// Set the visitor's health.
-		local_visitor.GetHealth() = visitor.person.GetHealth();
+		local_visitor.SetHealth(visitor.person.GetHealth());
 
 		// Add the visitor to their assigned clusters.
 		AddPersonToClusters(local_visitor);
@@ -175,6 +366,7 @@ multiregion::SimulationStepOutput Simulator::ReturnVisitors()
 	auto today = m_calendar->GetSimulationDay();
 	for (const auto& expatriate_pair : m_visitors.ExtractVisitors(today)) {
 		for (const auto& expatriate : expatriate_pair.second) {
+			RemovePersonFromClusters(m_population->getPerson(expatriate.visitor_id));
 			auto person = m_population->extract(expatriate.visitor_id);
 
 			// Recycle the person's id and their household.
@@ -233,10 +425,10 @@ multiregion::SimulationStepOutput Simulator::ReturnVisitors()
 		    today + (*m_travel_rng)(
 				(int)travel_model->GetMinTravelDuration(), (int)travel_model->GetMaxTravelDuration());
 
-		outgoing_visitors.emplace_back(visitor, target_region_id, return_date);
-
 		// Remove the person from the population and add them to the expatriate journal.
-		m_expatriates.AddExpatriate(m_population->extract(visitor.GetId()));
+		auto expatriate = m_population->extract(visitor.GetId());
+		outgoing_visitors.emplace_back(expatriate, target_region_id, return_date);
+		m_expatriates.AddExpatriate(expatriate);
 	}
 
 	return {std::move(outgoing_visitors), std::move(returning_expatriates)};
@@ -244,22 +436,28 @@ multiregion::SimulationStepOutput Simulator::ReturnVisitors()
 
 multiregion::SimulationStepOutput Simulator::TimeStep(const multiregion::SimulationStepInput& input)
 {
+	// A region may step on another thread than the one it was built on, which has threads of its
+	// own in the parallelization library. Pin those to the CPUs of this region as well.
+	if (m_config.common_config->numa_aware) {
+		util::pin_threads(m_num_threads, GetNumaFirstCpu());
+	}
 	AcceptVisitors(input);
-	shared_ptr<DaysOffInterface> days_off{nullptr};
 
 	// Logic where you compute (on the basis of input/config for initial day
 	// or on the basis of number of sick persons, duration of epidemic etc)
 	// what kind of DaysOff scheme you apply. If we want to make this cluster
 	// dependent then the days_off object has to be passed into the Update function.
-	days_off = make_shared<DaysOffStandard>(m_calendar);
-	const bool is_work_off{days_off->IsWorkOff()};
-	const bool is_school_off{days_off->IsSchoolOff()};
-
-	const double fraction_infected = m_population->get_fraction_infected();
-
-	m_population->parallel_for(m_num_threads, [=](const Person& p, unsigned int) {
-		p.Update(is_work_off, is_school_off, fraction_infected);
-	});
+	DaysOffStandard days_off(m_calendar);
+	const bool is_work_off{days_off.IsWorkOff()};
+	const bool is_school_off{days_off.IsSchoolOff()};
+
+	// Presence only depends on the type of day, health only changes on the days the
+	// fate of a person says so.
+	auto& store = m_population->get_store();
+	store.UpdatePresence(is_work_off, is_school_off);
+	m_infectiousness_changes.clear();
+	store.AdvanceDay(m_infectiousness_changes);
+	UpdateActiveClusters();
 
 	if (m_track_index_case) {
 		switch (m_log_level) {
@@ -3,7 +3,9 @@
 
 #include "behaviour/information_policies/NoLocalInformation.h"
 #include "core/Cluster.h"
+#include "core/ContactProbabilities.h"
 #include "core/DiseaseProfile.h"
+#include "core/Infector.h"
 #include "core/LogMode.h"
 #include "core/RngHandler.h"
 #include "multiregion/Visitor.h"
@@ -11,8 +13,10 @@
 #include "pop/Population.h"
 #include "sim/SimulationConfig.h"
 
+#include <array>
 #include <memory>
 #include <queue>
+#include <utility>
 #include <vector>
 #include <boost/property_tree/ptree.hpp>
 #include <spdlog/spdlog.h>
@@ -47,6 +51,9 @@ struct ClusterStruct
 
 	/// Container with secondary community Clusters.
 	std::vector<Cluster> m_secondary_community;
+
+	/// Returns the container with the Clusters of the given type.
+	std::vector<Cluster>& Get(ClusterType cluster_type);
 };
 
 /**
@@ -74,7 +81,11 @@ public:
 	ClusterStruct& GetClusters() { return m_clusters; }
 
 	/// Sets the population.
-	void SetPopulation(const std::shared_ptr<Population>& population) { m_population = population; }
+	void SetPopulation(const std::shared_ptr<Population>& population)
+	{
+		m_population = population;
+		m_active_clusters_stale = true;
+	}
 
 	/// Sets the visitor journal
 	void SetVisitors(const multiregion::VisitorJournal& visitors) { m_visitors = visitors; }
@@ -198,6 +209,17 @@ private:
 	/// Removes the given person from the clusters they've been assigned to.
 	void RemovePersonFromClusters(const Person& person);
 
+	/// Adds the clusters the given person has been assigned to to the active cluster lists.
+	void ActivateClusters(const Person& person);
+
+	/// Moves the given person to the members with its new health status in the clusters they've been
+	/// assigned to.
+	void UpdateMemberStatus(const Person& person);
+
+	/// Applies today's changes in infectiousness to the clusters and brings the active
+	/// cluster lists up to date.
+	void UpdateActiveClusters();
+
 	/// Generates an id for a person that is not in use.
 	PersonId GeneratePersonId();
 
@@ -215,6 +237,14 @@ private:
 		  typename local_information_policy = NoLocalInformation>
 	void UpdateClusters();
 
+	/// Visit the clusters with infectious members, the most expensive ones first.
+	template <typename TInfector, typename TKernelFor, typename TAction>
+	void SweepActiveClusters(const TKernelFor& kernel_for, const TAction& action);
+
+	/// Gets the first of the CPUs that the threads are pinned to when the run is NUMA aware. Every
+	/// region gets CPUs of its own, so that regions that run at the same time do not share them.
+	unsigned int GetNumaFirstCpu() const { return static_cast<unsigned int>(m_config.GetId() * m_num_threads); }
+
 private:
 	/// Configuration for this simulator.
 	SingleSimulationConfig m_config;
@@ -251,6 +281,30 @@ private:
 	/// Struct containing all Clusters.
 	ClusterStruct m_clusters;
 
+	/// Per cluster type, the sorted ids of the clusters that have infectious members.
+	std::array<std::vector<ClusterId>, NumOfClusterTypes()> m_active_clusters;
+
+	/// Per cluster type, whether a cluster id is in m_active_clusters.
+	std::array<std::vector<bool>, NumOfClusterTypes()> m_is_active_cluster;
+
+	/// Whether the active cluster lists have to be rebuilt from the clusters.
+	bool m_active_clusters_stale;
+
+	/// Clusters to visit today with their estimated cost, most expensive first.
+	std::vector<std::pair<std::size_t, Cluster*>> m_cluster_sweep;
+
+	/// Clusters to visit today that are divided over all threads.
+	std::vector<Cluster*> m_split_clusters;
+
+	/// Per thread, the transmissions sampled today.
+	std::vector<std::vector<Transmission>> m_transmissions;
+
+	/// Contact probabilities of the clusters, shared by clusters of the same type and size.
+	ContactProbabilityTable m_contact_probabilities;
+
+	/// Indices of the persons whose infectiousness changed today.
+	std::vector<PersonIndex> m_infectiousness_changes;
+
 	/// A list of unused households which can are eligible for recycling.
 	std::queue<std::size_t> m_unused_households;
 
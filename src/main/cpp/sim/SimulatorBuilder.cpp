@@ -11,6 +11,8 @@
 #include "sim/SimulationConfig.h"
 #include "util/Errors.h"
 #include "util/InstallDirs.h"
+#include "util/Numa.h"
+#include "util/Parallel.h"
 
 #include <iostream>
 #include <memory>
@@ -100,18 +102,21 @@ shared_ptr<Simulator> SimulatorBuilder::Build(
 
 	// Build population.
 	sim->m_travel_rng = rng;
-	sim->m_population = PopulationBuilder::Build(config, pt_disease, *rng, log);
+	sim->m_population = PopulationBuilder::Build(config, pt_disease, *rng, log, number_of_threads);
 
 	// Initialize clusters.
 	InitializeClusters(sim);
+	if (config.common_config->numa_aware) {
+		PlaceOnNumaNodes(sim);
+	}
 
 	// Initialize disease profile.
 	sim->m_disease_profile.Initialize(config, pt_disease);
 
-	// Initialize Rng handlers
+	// Initialize Rng handlers; they all draw from the same streams, keyed by day and cluster.
 	unsigned int new_seed = (*rng)(numeric_limits<unsigned int>::max());
 	for (size_t i = 0; i < sim->m_num_threads; i++) {
-		sim->m_rng_handler.emplace_back(RngHandler(new_seed, sim->m_num_threads, i));
+		sim->m_rng_handler.emplace_back(RngHandler(new_seed));
 	}
 
 	// Initialize contact profiles.
@@ -175,6 +180,21 @@ void SimulatorBuilder::InitializeClusters(shared_ptr<Simulator> sim)
 	population.serial_for([&](const Person& p, unsigned int) -> void { sim->AddPersonToClusters(p); });
 }
 
+void SimulatorBuilder::PlaceOnNumaNodes(shared_ptr<Simulator> sim)
+{
+	// Pin first, so that the threads write the data on the node they stay on. Without pinning, the
+	// threads would move the data around again.
+	if (!pin_threads(sim->m_num_threads, sim->GetNumaFirstCpu())) {
+		return;
+	}
+	sim->m_population->get_store().FirstTouch(sim->m_num_threads);
+	for (std::size_t type = 0; type < NumOfClusterTypes(); type++) {
+		parallel::parallel_for(
+		    sim->m_clusters.Get(static_cast<ClusterType>(type)), sim->m_num_threads,
+		    [](Cluster& cluster, unsigned int) { cluster.FirstTouch(); });
+	}
+}
+
 #if USE_HDF5
 shared_ptr<Simulator> SimulatorBuilder::Load(
     const SingleSimulationConfig& config, const std::shared_ptr<spdlog::logger>& log,
@@ -225,10 +245,10 @@ shared_ptr<Simulator> SimulatorBuilder::Load(
 	// Initialize disease profile.
 	sim->m_disease_profile.Initialize(config, pt_disease);
 
-	// Initialize Rng handlers
+	// Initialize Rng handlers; they all draw from the same streams, keyed by day and cluster.
 	unsigned int new_seed = (*rng)(numeric_limits<unsigned int>::max());
 	for (size_t i = 0; i < sim->m_num_threads; i++) {
-		sim->m_rng_handler.emplace_back(RngHandler(new_seed, sim->m_num_threads, i));
+		sim->m_rng_handler.emplace_back(RngHandler(new_seed));
 	}
 
 	// Initialize contact profiles.
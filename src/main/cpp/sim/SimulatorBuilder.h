@@ -62,6 +62,10 @@ public:
 private:
 	/// Initialize the clusters.
 	static void InitializeClusters(std::shared_ptr<Simulator> sim);
+
+	/// Pins the threads and moves the person and cluster data to the NUMA nodes of the threads that
+	/// visit them in parallel loops, if the threads can be pinned.
+	static void PlaceOnNumaNodes(std::shared_ptr<Simulator> sim);
 };
 
 } // end_of_namespace
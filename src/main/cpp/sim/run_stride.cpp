@@ -12,6 +12,7 @@
 #include "util/Errors.h"
 #include "util/ExternalVars.h"
 #include "util/InstallDirs.h"
+#include "util/Numa.h"
 #include "util/Parallel.h"
 #include "util/Stopwatch.h"
 #include "util/TimeStamp.h"
@@ -260,6 +261,20 @@ void run_stride(const MultiSimulationConfig& config)
 
 	cout << "Done building simulators. " << endl << endl;
 
+	// Report how much of the person data is on another NUMA node than the thread that visits it.
+	if (config.common_config->numa_aware && !util::can_pin_threads()) {
+		cout << "Threads cannot be pinned with " << util::parallel::parallelization_library_name
+		     << ", so the data is not placed on NUMA nodes." << endl
+		     << endl;
+	} else if (config.common_config->numa_aware) {
+		for (const auto& sim_tuple : tasks) {
+			const auto& store = sim_tuple.sim_task->GetPopulation()->get_store();
+			cout << "Remote NUMA pages of simulator #" << sim_tuple.sim_config.GetId() << ": "
+			     << store.CountRemotePages(num_threads) << endl;
+		}
+		cout << endl;
+	}
+
 	// -----------------------------------------------------------------------------------------
 	// Run the simulation.
 	// -----------------------------------------------------------------------------------------
@@ -0,0 +1,34 @@
+#ifndef BITS_H_INCLUDED
+#define BITS_H_INCLUDED
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace stride {
+namespace util {
+
+/// Get the position of the lowest set bit of the given word, which must not be zero.
+inline unsigned int count_trailing_zeros(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned int>(__builtin_ctzll(word));
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long position;
+	_BitScanForward64(&position, word);
+	return static_cast<unsigned int>(position);
+#else
+	unsigned int position = 0U;
+	for (; (word & 1U) == 0U; word >>= 1) {
+		position++;
+	}
+	return position;
+#endif
+}
+
+} // namespace util
+} // namespace stride
+
+#endif // end-of-include-guard
@@ -0,0 +1,46 @@
+#ifndef DEFAULT_INIT_ALLOCATOR_H_INCLUDED
+#define DEFAULT_INIT_ALLOCATOR_H_INCLUDED
+
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace stride {
+namespace util {
+
+/**
+ * An allocator that default-initializes the elements that a container constructs without a value,
+ * instead of value-initializing them. For trivial types, resizing a vector with it then leaves the
+ * new elements unwritten, so that the pages they live on are first touched by whoever writes them.
+ */
+template <typename T, typename A = std::allocator<T>>
+class DefaultInitAllocator : public A
+{
+public:
+	using A::A;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = DefaultInitAllocator<U, typename std::allocator_traits<A>::template rebind_alloc<U>>;
+	};
+
+	/// Default-initializes an element.
+	template <typename U>
+	void construct(U* p)
+	{
+		::new (static_cast<void*>(p)) U;
+	}
+
+	/// Constructs an element from the given arguments, like the underlying allocator.
+	template <typename U, typename... TArgs>
+	void construct(U* p, TArgs&&... args)
+	{
+		std::allocator_traits<A>::construct(static_cast<A&>(*this), p, std::forward<TArgs>(args)...);
+	}
+};
+
+} // namespace util
+} // namespace stride
+
+#endif // end-of-include-guard
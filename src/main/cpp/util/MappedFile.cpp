@@ -0,0 +1,64 @@
+#include "MappedFile.h"
+
+#include "util/Errors.h"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace stride {
+namespace util {
+
+MappedFile::MappedFile(const boost::filesystem::path& path) : m_data(nullptr), m_size(0U), m_mapped(false)
+{
+	if (!boost::filesystem::is_regular_file(path)) {
+		FATAL_ERROR("File " + path.string() + " not present.");
+	}
+
+#if defined(__unix__) || defined(__APPLE__)
+	const int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		FATAL_ERROR("Error opening file " + path.string());
+	}
+	m_size = static_cast<std::size_t>(boost::filesystem::file_size(path));
+	if (m_size > 0U) {
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			// The file is parsed front to back, so let the kernel read ahead.
+			madvise(data, m_size, MADV_SEQUENTIAL);
+			m_data = static_cast<const char*>(data);
+			m_mapped = true;
+		}
+	}
+	close(fd);
+	if (m_mapped || m_size == 0U) {
+		return;
+	}
+#endif
+
+	boost::filesystem::ifstream stream(path, std::ios::binary);
+	if (!stream.is_open()) {
+		FATAL_ERROR("Error opening file " + path.string());
+	}
+	m_buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	if (m_mapped) {
+		munmap(const_cast<char*>(m_data), m_size);
+	}
+#endif
+}
+
+} // namespace util
+} // namespace stride
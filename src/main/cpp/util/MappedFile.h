@@ -0,0 +1,48 @@
+#ifndef UTIL_MAPPED_FILE_H_INCLUDED
+#define UTIL_MAPPED_FILE_H_INCLUDED
+
+#include <boost/filesystem/path.hpp>
+#include <cstddef>
+#include <string>
+
+namespace stride {
+namespace util {
+
+/**
+ * A read-only view of the contents of a file. Where the platform supports it, the file is mapped
+ * into memory, so that it is read in by the pages that are used instead of copied into a buffer.
+ * Elsewhere, the file is read into a buffer.
+ */
+class MappedFile
+{
+public:
+	/// Maps the file at the given path; fails with a fatal error if it cannot be opened.
+	explicit MappedFile(const boost::filesystem::path& path);
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/// Unmaps the file.
+	~MappedFile();
+
+	/// Get the first byte of the file.
+	const char* GetData() const { return m_data; }
+
+	/// Get the size of the file in bytes.
+	std::size_t GetSize() const { return m_size; }
+
+private:
+	const char* m_data;
+	std::size_t m_size;
+
+	/// Whether m_data is a mapping, rather than a pointer into m_buffer.
+	bool m_mapped;
+
+	/// The contents of the file, if it could not be mapped.
+	std::string m_buffer;
+};
+
+} // namespace util
+} // namespace stride
+
+#endif // end-of-include-guard
@@ -0,0 +1,128 @@
+#include "Numa.h"
+
+#include "util/Parallel.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace stride {
+namespace util {
+
+#ifdef __linux__
+
+namespace {
+
+/// Gets the CPUs the process may use, as they were when this was first called.
+const std::vector<int>& get_allowed_cpus()
+{
+	static const std::vector<int> cpus = [] {
+		std::vector<int> result;
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+			for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+				if (CPU_ISSET(cpu, &mask)) {
+					result.push_back(cpu);
+				}
+			}
+		}
+		return result;
+	}();
+	return cpus;
+}
+
+/// Pins the calling thread to the given CPU.
+bool pin_current_thread(int cpu)
+{
+	cpu_set_t mask;
+	CPU_ZERO(&mask);
+	CPU_SET(cpu, &mask);
+	return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+}
+
+} // namespace
+
+bool can_pin_threads()
+{
+#if defined PARALLELIZATION_LIBRARY_TBB || defined PARALLELIZATION_LIBRARY_PSTL
+	return false;
+#else
+	return !get_allowed_cpus().empty();
+#endif
+}
+
+bool pin_threads(unsigned int num_threads, unsigned int first_cpu)
+{
+	if (!can_pin_threads()) {
+		return false;
+	}
+	const auto& cpus = get_allowed_cpus();
+	std::atomic<bool> success(true);
+	parallel::parallel_for_chunks(0, num_threads, num_threads, [&](std::size_t, std::size_t, unsigned int id) {
+		if (id != 0 && !pin_current_thread(cpus[(first_cpu + id) % cpus.size()])) {
+			success = false;
+		}
+	});
+	return success;
+}
+
+int get_numa_node()
+{
+	unsigned int cpu = 0U;
+	unsigned int node = 0U;
+	if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+		return -1;
+	}
+	return static_cast<int>(node);
+}
+
+std::size_t count_remote_pages(const void* begin, std::size_t size, int node)
+{
+	if (size == 0 || node < 0) {
+		return 0;
+	}
+	const auto page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+	const auto first = reinterpret_cast<std::uintptr_t>(begin) / page_size * page_size;
+	const auto last = reinterpret_cast<std::uintptr_t>(begin) + size;
+
+	// Query the nodes of the pages in batches; pages that are not resident report a negative status.
+	const std::size_t batch_size = 1024U;
+	std::vector<void*> pages;
+	std::vector<int> status(batch_size);
+	std::size_t result = 0;
+	for (auto page = first; page < last;) {
+		pages.clear();
+		for (; page < last && pages.size() < batch_size; page += page_size) {
+			pages.push_back(reinterpret_cast<void*>(page));
+		}
+		if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+			return 0;
+		}
+		for (std::size_t i = 0; i < pages.size(); i++) {
+			result += status[i] >= 0 && status[i] != node;
+		}
+	}
+	return result;
+}
+
+#else
+
+bool can_pin_threads() { return false; }
+
+bool pin_threads(unsigned int, unsigned int) { return false; }
+
+int get_numa_node() { return -1; }
+
+std::size_t count_remote_pages(const void*, std::size_t, int) { return 0; }
+
+#endif
+
+} // namespace util
+} // namespace stride
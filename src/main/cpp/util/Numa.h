@@ -0,0 +1,37 @@
+#ifndef UTIL_NUMA_H_INCLUDED
+#define UTIL_NUMA_H_INCLUDED
+
+/**
+ * @file
+ * Placement of threads and memory on machines with several NUMA nodes (sockets). On a NUMA
+ * machine, a page of memory lives on the node of the thread that first writes it. Data that a
+ * thread works on should thus be written first by that same thread, and that thread should stay
+ * on the same node. These functions only have an effect on Linux.
+ */
+
+#include <cstddef>
+
+namespace stride {
+namespace util {
+
+/// Tells if pin_threads can pin threads. That needs Linux, and a parallelization library that runs
+/// a thread id on the same thread from loop to loop: OpenMP or the STL pool, not TBB or the
+/// parallel algorithms.
+bool can_pin_threads();
+
+/// Pins the threads of parallel_for_chunks with num_threads threads to CPUs of their own: thread id
+/// i runs on CPU first_cpu + i of the CPUs the process may use. Thread id 0 is the calling thread,
+/// which is left to the scheduler. Returns false if the threads cannot be pinned.
+bool pin_threads(unsigned int num_threads, unsigned int first_cpu);
+
+/// Gets the NUMA node of the CPU the calling thread runs on, or -1 if it is not known.
+int get_numa_node();
+
+/// Counts the pages of [begin, begin + size) that are resident on another NUMA node than the
+/// given one. Returns 0 if the nodes of pages cannot be queried on this platform.
+std::size_t count_remote_pages(const void* begin, std::size_t size, int node);
+
+} // namespace util
+} // namespace stride
+
+#endif // end-of-include-guard
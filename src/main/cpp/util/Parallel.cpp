@@ -1,13 +1,30 @@
 #include "Parallel.h"
 
+#include <condition_variable>
+
 namespace stride {
 namespace util {
 namespace parallel {
 
 #ifdef PARALLELIZATION_LIBRARY_TBB
 namespace {
-unsigned int tbb_number_of_threads = tbb::task_scheduler_init::default_num_threads();
+unsigned int tbb_number_of_threads = static_cast<unsigned int>(tbb::this_task_arena::max_concurrency());
+
+/// The task arenas of the current thread, by number of threads. Threads that run loops at the same
+/// time, such as the simulators of several regions, get arenas of their own that share the workers.
+thread_local std::map<unsigned int, std::unique_ptr<tbb::task_arena>> tbb_task_arenas;
 }
+
+tbb::task_arena& get_task_arena(unsigned int num_threads)
+{
+	num_threads = std::max(num_threads, 1U);
+	auto& arena = tbb_task_arenas[num_threads];
+	if (!arena) {
+		arena.reset(new tbb::task_arena(static_cast<int>(num_threads)));
+	}
+	return *arena;
+}
+
 unsigned int get_number_of_threads() { return tbb_number_of_threads; }
 
 bool try_set_number_of_threads(unsigned int number_of_threads)
@@ -19,7 +36,7 @@ bool try_set_number_of_threads(unsigned int number_of_threads)
 	return true;
 }
 
-#elif defined PARALLELIZATION_LIBRARY_STL
+#elif defined PARALLELIZATION_LIBRARY_STL || defined PARALLELIZATION_LIBRARY_PSTL
 
 namespace {
 unsigned int stl_number_of_threads = std::thread::hardware_concurrency();
@@ -74,6 +91,185 @@ unsigned int get_number_of_threads() { return 1; }
 bool try_set_number_of_threads(unsigned int) { return false; }
 
 #endif
+
+#ifdef PARALLELIZATION_LIBRARY_STL
+
+namespace {
+
+/// Number of times a waiting thread checks for its wake-up before it goes to sleep.
+constexpr unsigned int g_spin_count = 4096U;
+
+/// Counts down the thread ids of a call to ThreadPool::Run that are still running.
+class Latch
+{
+public:
+	explicit Latch(unsigned int count) : m_count(count) {}
+
+	/// Marks one thread id as done.
+	void CountDown()
+	{
+		if (m_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_done.notify_all();
+		}
+	}
+
+	/// Waits until all thread ids are done. The caller usually finishes last, so it spins before
+	/// it sleeps.
+	void Wait()
+	{
+		for (unsigned int spin = 0; spin < g_spin_count; spin++) {
+			if (m_count.load(std::memory_order_acquire) == 0) {
+				return;
+			}
+			std::this_thread::yield();
+		}
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] { return m_count.load(std::memory_order_acquire) == 0; });
+	}
+
+private:
+	std::atomic<unsigned int> m_count;
+	std::mutex m_mutex;
+	std::condition_variable m_done;
+};
+
+} // namespace
+
+/// A thread that waits for a task, runs it for one thread id and waits for the next task.
+class ThreadPool::Worker
+{
+public:
+	Worker() : m_task(nullptr), m_thread_id(0), m_latch(nullptr), m_stop(false), m_thread([this] { Loop(); }) {}
+
+	~Worker()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wakeup.notify_one();
+		m_thread.join();
+	}
+
+	/// Runs the task for the given thread id and counts down the latch when done.
+	void Start(const Task* task, unsigned int thread_id, Latch* latch)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_thread_id = thread_id;
+			m_latch = latch;
+			m_task.store(task, std::memory_order_release);
+		}
+		m_wakeup.notify_one();
+	}
+
+private:
+	void Loop()
+	{
+		for (;;) {
+			// Spin for a little while, since loops tend to follow each other closely.
+			const Task* task = nullptr;
+			for (unsigned int spin = 0; spin < g_spin_count && task == nullptr; spin++) {
+				task = m_task.load(std::memory_order_acquire);
+				if (task == nullptr) {
+					std::this_thread::yield();
+				}
+			}
+			if (task == nullptr) {
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wakeup.wait(lock, [this, &task] {
+					task = m_task.load(std::memory_order_acquire);
+					return task != nullptr || m_stop;
+				});
+				if (task == nullptr) {
+					return;
+				}
+			}
+			m_task.store(nullptr, std::memory_order_relaxed);
+			{
+				LoopThreadIdGuard guard(m_thread_id);
+				(*task)(m_thread_id);
+			}
+			m_latch->CountDown();
+		}
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_wakeup;
+	std::atomic<const Task*> m_task;
+	unsigned int m_thread_id;
+	Latch* m_latch;
+	bool m_stop;
+	std::thread m_thread;
+};
+
+ThreadPool& ThreadPool::Instance()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+ThreadPool::~ThreadPool() = default;
+
+void ThreadPool::Run(unsigned int num_threads, const Task& task)
+{
+	if (loop_thread_id() >= 0) {
+		// Keep the thread id of the enclosing task, whose per-thread data this thread is using.
+		task(static_cast<unsigned int>(loop_thread_id()));
+		return;
+	}
+	if (num_threads <= 1) {
+		task(0);
+		return;
+	}
+
+	// Claim the first idle workers, and start new ones if there are not enough.
+	std::vector<Worker*> workers;
+	std::vector<std::size_t> positions;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (std::size_t i = 0; i < m_workers.size() && workers.size() + 1 < num_threads; i++) {
+			if (m_idle[i]) {
+				m_idle[i] = false;
+				workers.push_back(m_workers[i].get());
+				positions.push_back(i);
+			}
+		}
+		while (workers.size() + 1 < num_threads) {
+			m_workers.emplace_back(new Worker());
+			m_idle.push_back(false);
+			workers.push_back(m_workers.back().get());
+			positions.push_back(m_workers.size() - 1);
+		}
+	}
+
+	Latch latch(static_cast<unsigned int>(workers.size()));
+	for (std::size_t i = 0; i < workers.size(); i++) {
+		workers[i]->Start(&task, static_cast<unsigned int>(i + 1), &latch);
+	}
+	try {
+		LoopThreadIdGuard guard(0U);
+		task(0);
+	} catch (...) {
+		latch.Wait();
+		Release(positions);
+		throw;
+	}
+	latch.Wait();
+	Release(positions);
+}
+
+void ThreadPool::Release(const std::vector<std::size_t>& positions)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto i : positions) {
+		m_idle[i] = true;
+	}
+}
+
+#endif
+}
 }
 }
-}
\ No newline at end of file
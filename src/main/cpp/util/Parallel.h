@@ -6,16 +6,23 @@
  * A paper-thin abstraction layer over parallelization libraries.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
 #ifdef PARALLELIZATION_LIBRARY_TBB
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
-#include <tbb/task_scheduler_init.h>
-#include <tbb/tbb_thread.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#elif defined PARALLELIZATION_LIBRARY_PSTL
+#include <execution>
+#include <numeric>
 #elif !defined PARALLELIZATION_LIBRARY_STL && !defined PARALLELIZATION_LIBRARY_NONE
 #include <omp.h>
 #endif
@@ -40,6 +47,43 @@ bool try_set_number_of_threads(unsigned int number_of_threads);
 template <typename T, typename TAction>
 void parallel_for(std::vector<T>& values, unsigned int num_threads, const TAction& action);
 
+/// Applies the given action to each index in the range [first, last).
+/// The action may be applied to up to num_threads indices simultaneously.
+/// An action is a function object with signature `void(std::size_t, unsigned int)`
+/// where the first parameter is the index and the second parameter is the index
+/// of the thread it runs on. A loop that is started from within the action of another
+/// loop runs serially on the calling thread, with the thread index of that action, so
+/// that per-thread data is never used by two threads at once.
+template <typename TAction>
+void parallel_for_range(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action);
+
+/// Applies the given action to each index in the range [first, last), like parallel_for_range.
+/// Indices are handed out one at a time in increasing order to whichever thread is idle, so
+/// when the most expensive indices come first, the load stays balanced across threads.
+template <typename TAction>
+void parallel_for_dynamic(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action);
+
+/// Splits the range [first, last) into num_threads chunks of consecutive indices, as CreateChunks
+/// does, and applies the given action to the bounds of each chunk. An action is a function object
+/// with signature `void(std::size_t, std::size_t, unsigned int)` where the parameters are the first
+/// and the past-the-end index of the chunk and the index of the thread it runs on. With OpenMP and
+/// the STL pool, chunk i runs with thread id i, on the same thread from loop to loop as long as no
+/// other loops run at the same time: loops over rows that are first written in such a loop then
+/// visit them on the NUMA node they were placed on. TBB and the parallel algorithms do not keep a
+/// thread per thread id, so there a chunk runs on whichever thread is idle.
+template <typename TAction>
+void parallel_for_chunks(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action);
+
+/// Applies the given action to each index in the range [first, last).
+/// The action is not applied to multiple indices simultaneously.
+template <typename TAction>
+void serial_for_range(std::size_t first, std::size_t last, const TAction& action)
+{
+	for (std::size_t i = first; i < last; i++) {
+		action(i, 0);
+	}
+}
+
 /// Applies the given action to each element in the given list of values.
 /// The action is not applied to multiple elements simultaneously.
 /// An action is a function object with signature `void(T&, unsigned int)`
@@ -99,31 +143,52 @@ struct CreateChunks
 	}
 };
 
-/// A thread-safe queue.
-template <typename T>
-struct ConcurrentQueue final
+/// The thread id of the loop action that the calling thread is running, or -1 outside of loops.
+inline int& loop_thread_id()
 {
-	/// Dequeues an item from this concurrent queue.
-	T Dequeue()
-	{
-		std::lock_guard<std::mutex> lock(mutex);
-		auto result = queue.front();
-		queue.pop();
-		return result;
-	}
+	static thread_local int thread_id = -1;
+	return thread_id;
+}
 
-	/// Enqueues an item in this concurrent queue.
-	void Enqueue(const T& value)
+/// Sets the loop thread id of the calling thread for as long as it exists.
+class LoopThreadIdGuard
+{
+public:
+	explicit LoopThreadIdGuard(unsigned int thread_id) : m_previous(loop_thread_id())
 	{
-		std::lock_guard<std::mutex> lock(mutex);
-		queue.push(value);
+		loop_thread_id() = static_cast<int>(thread_id);
 	}
 
+	~LoopThreadIdGuard() { loop_thread_id() = m_previous; }
+
 private:
-	std::queue<T> queue;
-	std::mutex mutex;
+	int m_previous;
 };
 
+/// Applies the action to the bounds of the given chunk of CreateChunks, on the given thread id.
+template <typename TAction>
+void run_chunk(
+    std::size_t first, const std::vector<std::size_t>& chunks, std::size_t chunk, unsigned int thread_id,
+    const TAction& action)
+{
+	action(first + (chunk == 0 ? 0 : chunks[chunk - 1]), first + chunks[chunk], thread_id);
+}
+
+/// Runs a loop serially with the thread id of the enclosing loop, if the calling thread is running
+/// the action of a loop. Tells if it did.
+template <typename TAction>
+bool run_nested(std::size_t first, std::size_t last, const TAction& action)
+{
+	const int thread_id = loop_thread_id();
+	if (thread_id < 0) {
+		return false;
+	}
+	for (std::size_t i = first; i < last; i++) {
+		action(i, static_cast<unsigned int>(thread_id));
+	}
+	return true;
+}
+
 #ifdef PARALLELIZATION_LIBRARY_TBB
 
 /// The name of the parallelization library that is in use.
@@ -132,25 +197,141 @@ const char* const parallelization_library_name = "TBB";
 /// Tells if a parallelization library is in use.
 const bool using_parallelization_library = true;
 
-template <typename T, typename TAction>
-void parallel_for(std::vector<T>& values, unsigned int num_threads, const TAction& action)
+/// Get the task arena of the calling thread with the given number of threads. Each arena is created
+/// on first use and kept until the thread exits, so that a loop reuses the workers of the previous one.
+/// Inside the arena, `tbb::this_task_arena::current_thread_index()` is in [0, num_threads) and
+/// unique among the threads that are running, so it serves as thread id.
+tbb::task_arena& get_task_arena(unsigned int num_threads);
+
+/// Gets the thread id of the calling thread inside its task arena.
+inline unsigned int get_thread_id() { return static_cast<unsigned int>(tbb::this_task_arena::current_thread_index()); }
+
+/// Applies the action to each index in the given range, with the thread id of the calling thread.
+/// The thread index in the arena of a nested loop could be that of another thread of the enclosing
+/// loop, so nested loops do not enter an arena.
+template <typename TAction>
+void run_range(const tbb::blocked_range<std::size_t>& range, const TAction& action)
+{
+	const auto thread_id = get_thread_id();
+	LoopThreadIdGuard guard(thread_id);
+	for (std::size_t i = range.begin(); i != range.end(); i++) {
+		action(i, thread_id);
+	}
+}
+
+template <typename TAction>
+void parallel_for_range(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
 {
-	ConcurrentQueue<unsigned int> thread_id_pool;
-	for (unsigned int i = 0; i < num_threads; i++) {
-		thread_id_pool.Enqueue(i);
+	if (run_nested(first, last, action)) {
+		return;
 	}
+	get_task_arena(num_threads).execute([first, last, &action] {
+		tbb::parallel_for(
+		    tbb::blocked_range<std::size_t>(first, last),
+		    [&action](const tbb::blocked_range<std::size_t>& r) { run_range(r, action); });
+	});
+}
 
-	tbb::task_scheduler_init init(num_threads);
+template <typename TAction>
+void parallel_for_dynamic(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	if (run_nested(first, last, action)) {
+		return;
+	}
+	// Ranges of a single index, so that idle threads steal individual indices.
+	get_task_arena(num_threads).execute([first, last, &action] {
+		tbb::parallel_for(
+		    tbb::blocked_range<std::size_t>(first, last, 1),
+		    [&action](const tbb::blocked_range<std::size_t>& r) { run_range(r, action); },
+		    tbb::simple_partitioner());
+	});
+}
 
-	tbb::parallel_for(
-	    tbb::blocked_range<size_t>(0, values.size()),
-	    [&action, &values, &thread_id_pool](const tbb::blocked_range<size_t>& r) {
-		    auto thread_id = thread_id_pool.Dequeue();
-		    for (size_t i = r.begin(); i != r.end(); i++) {
-			    action(values[i], thread_id);
-		    }
-		    thread_id_pool.Enqueue(thread_id);
-	    });
+template <typename TAction>
+void parallel_for_chunks(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	num_threads = std::max(num_threads, 1U);
+	const auto chunks = CreateChunks<std::size_t>()(last - first, num_threads);
+	parallel_for_range(0, num_threads, num_threads, [&](std::size_t chunk, unsigned int thread_id) {
+		run_chunk(first, chunks, chunk, thread_id, action);
+	});
+}
+
+#elif defined PARALLELIZATION_LIBRARY_PSTL
+
+/// The name of the parallelization library that is in use.
+const char* const parallelization_library_name = "PSTL";
+
+/// Tells if a parallelization library is in use.
+const bool using_parallelization_library = true;
+
+/// The parallel algorithms of the standard library do not tell which thread runs an element, so the
+/// loops run std::for_each over num_threads slots instead of over the indices. The slot is the thread
+/// id: two slots may run at the same time, one slot never runs on two threads at once. The policy is
+/// std::execution::par rather than par_unseq, because actions take locks (logging, per-thread
+/// buffers) and those are not allowed in unsequenced code; the loop over the indices of a slot is
+/// an ordinary loop that the compiler may still vectorize.
+template <typename TSlotAction>
+void for_each_slot(unsigned int num_threads, const TSlotAction& slot_action)
+{
+	std::vector<unsigned int> slots(num_threads);
+	std::iota(slots.begin(), slots.end(), 0U);
+	std::for_each(std::execution::par, slots.begin(), slots.end(), [&slot_action](unsigned int slot) {
+		LoopThreadIdGuard guard(slot);
+		slot_action(slot);
+	});
+}
+
+template <typename TAction>
+void parallel_for_range(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	if (run_nested(first, last, action)) {
+		return;
+	}
+	if (num_threads <= 1 || last - first <= 1) {
+		// Nothing to parallelize.
+		serial_for_range(first, last, action);
+	} else {
+		// Each slot gets one static chunk of the range.
+		const auto chunks = CreateChunks<std::size_t>()(last - first, num_threads);
+		for_each_slot(num_threads, [&action, &chunks, first](unsigned int slot) {
+			const std::size_t begin = first + (slot == 0 ? 0 : chunks[slot - 1]);
+			const std::size_t end = first + chunks[slot];
+			for (std::size_t i = begin; i < end; i++) {
+				action(i, slot);
+			}
+		});
+	}
+}
+
+template <typename TAction>
+void parallel_for_dynamic(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	if (run_nested(first, last, action)) {
+		return;
+	}
+	if (num_threads <= 1 || last - first <= 1) {
+		// Nothing to parallelize.
+		serial_for_range(first, last, action);
+	} else {
+		// Each slot claims the next index whenever it is done.
+		std::atomic<std::size_t> next(first);
+		for_each_slot(num_threads, [&action, &next, last](unsigned int slot) {
+			for (auto i = next.fetch_add(1); i < last; i = next.fetch_add(1)) {
+				action(i, slot);
+			}
+		});
+	}
+}
+
+template <typename TAction>
+void parallel_for_chunks(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	num_threads = std::max(num_threads, 1U);
+	const auto chunks = CreateChunks<std::size_t>()(last - first, num_threads);
+	parallel_for_range(0, num_threads, num_threads, [&](std::size_t chunk, unsigned int thread_id) {
+		run_chunk(first, chunks, chunk, thread_id, action);
+	});
 }
 
 #elif defined PARALLELIZATION_LIBRARY_STL
@@ -161,31 +342,109 @@ const char* const parallelization_library_name = "STL";
 /// Tells if a parallelization library is in use.
 const bool using_parallelization_library = true;
 
-template <typename T, typename TAction>
-void parallel_for(std::vector<T>& values, unsigned int num_threads, const TAction& action)
+/**
+ * The worker threads that run the parallel loops of the process. Workers are started the first time
+ * they are needed and are reused by every later loop, so that a loop only costs a wake-up and a
+ * barrier instead of creating and joining a thread per chunk.
+ */
+class ThreadPool final
+{
+public:
+	/// A task runs once for every thread id of a call to Run.
+	using Task = std::function<void(unsigned int)>;
+
+	/// Get the pool of the process.
+	static ThreadPool& Instance();
+
+	/// Stops and joins the workers.
+	~ThreadPool();
+
+	/// Runs the task for each thread id in [0, num_threads) simultaneously and waits until all of
+	/// them are done. Thread id 0 runs on the calling thread and id i on the i-th idle worker, so
+	/// that the same id runs on the same worker from loop to loop. Calls from within a task run
+	/// the task once on the current thread, with the thread id of the enclosing task.
+	void Run(unsigned int num_threads, const Task& task);
+
+private:
+	class Worker;
+
+	ThreadPool() = default;
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// Marks the workers at the given positions as idle again.
+	void Release(const std::vector<std::size_t>& positions);
+
+private:
+	/// Guards m_workers and m_idle.
+	std::mutex m_mutex;
+
+	/// The workers, in the order in which they are handed out.
+	std::vector<std::unique_ptr<Worker>> m_workers;
+
+	/// Tells which workers are not running a task.
+	std::vector<bool> m_idle;
+};
+
+template <typename TAction>
+void parallel_for_range(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
 {
-	if (num_threads <= 1) {
+	if (run_nested(first, last, action)) {
+		return;
+	}
+	if (num_threads <= 1 || last - first <= 1) {
 		// Nothing to parallelize.
-		serial_for<T, TAction>(values, action);
+		serial_for_range(first, last, action);
 	} else {
-		// Create num_thread threads and divide the workload statically.
-		std::vector<std::thread> thread_pool;
-		auto chunks = CreateChunks<std::size_t>()(values.size(), num_threads);
-		std::size_t values_start_offset = 0;
-		for (std::size_t i = 0; i < chunks.size(); i++) {
-			auto next_start_offset = chunks[i];
-			thread_pool.emplace_back([&values, &action, i, values_start_offset, next_start_offset] {
-				for (size_t j = values_start_offset; j < next_start_offset; j++) {
-					action(values[j], i);
+		// The threads claim chunks of a few indices whenever they are done, so that a thread that
+		// runs late (or is a worker that is still waking up) does not hold up the others.
+		const std::size_t chunk_size = std::max<std::size_t>(1, (last - first) / (8 * num_threads));
+		std::atomic<std::size_t> next(first);
+		ThreadPool::Instance().Run(num_threads, [&action, &next, chunk_size, last](unsigned int thread_id) {
+			for (auto j = next.fetch_add(chunk_size); j < last; j = next.fetch_add(chunk_size)) {
+				const auto chunk_end = std::min(j + chunk_size, last);
+				for (; j < chunk_end; j++) {
+					action(j, thread_id);
 				}
-			});
-			values_start_offset = next_start_offset;
-		}
+			}
+		});
+	}
+}
 
-		// Wait for the threads to finish.
-		for (auto& thread : thread_pool) {
-			thread.join();
+template <typename TAction>
+void parallel_for_dynamic(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	if (run_nested(first, last, action)) {
+		return;
+	}
+	if (num_threads <= 1 || last - first <= 1) {
+		// Nothing to parallelize.
+		serial_for_range(first, last, action);
+	} else {
+		// The threads claim the next index whenever they are done.
+		std::atomic<std::size_t> next(first);
+		ThreadPool::Instance().Run(num_threads, [&action, &next, last](unsigned int thread_id) {
+			for (auto j = next.fetch_add(1); j < last; j = next.fetch_add(1)) {
+				action(j, thread_id);
+			}
+		});
+	}
+}
+
+template <typename TAction>
+void parallel_for_chunks(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	num_threads = std::max(num_threads, 1U);
+	const auto chunks = CreateChunks<std::size_t>()(last - first, num_threads);
+	const int outer_thread_id = loop_thread_id();
+	if (outer_thread_id >= 0) {
+		for (std::size_t chunk = 0; chunk < num_threads; chunk++) {
+			run_chunk(first, chunks, chunk, static_cast<unsigned int>(outer_thread_id), action);
 		}
+	} else {
+		ThreadPool::Instance().Run(num_threads, [&](unsigned int thread_id) {
+			run_chunk(first, chunks, thread_id, thread_id, action);
+		});
 	}
 }
 
@@ -197,13 +456,59 @@ const char* const parallelization_library_name = "OpenMP";
 /// Tells if a parallelization library is in use.
 const bool using_parallelization_library = true;
 
-template <typename T, typename TAction>
-void parallel_for(std::vector<T>& values, unsigned int num_threads, const TAction& action)
+template <typename TAction>
+void parallel_for_range(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
 {
+	if (omp_in_parallel()) {
+		// A nested parallel region would number its threads from 0 again.
+		const unsigned int thread_id = omp_get_thread_num();
+		for (size_t i = first; i < last; i++) {
+			action(i, thread_id);
+		}
+		return;
+	}
 #pragma omp parallel for num_threads(num_threads) schedule(runtime)
-	for (size_t i = 0; i < values.size(); i++) {
+	for (size_t i = first; i < last; i++) {
 		const unsigned int thread_id = omp_get_thread_num();
-		action(values[i], thread_id);
+		action(i, thread_id);
+	}
+}
+
+template <typename TAction>
+void parallel_for_dynamic(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	if (omp_in_parallel()) {
+		// A nested parallel region would number its threads from 0 again.
+		const unsigned int thread_id = omp_get_thread_num();
+		for (size_t i = first; i < last; i++) {
+			action(i, thread_id);
+		}
+		return;
+	}
+#pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1)
+	for (size_t i = first; i < last; i++) {
+		const unsigned int thread_id = omp_get_thread_num();
+		action(i, thread_id);
+	}
+}
+
+template <typename TAction>
+void parallel_for_chunks(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	num_threads = std::max(num_threads, 1U);
+	const auto chunks = CreateChunks<std::size_t>()(last - first, num_threads);
+	if (omp_in_parallel()) {
+		const unsigned int thread_id = omp_get_thread_num();
+		for (std::size_t chunk = 0; chunk < num_threads; chunk++) {
+			run_chunk(first, chunks, chunk, thread_id, action);
+		}
+		return;
+	}
+	// A static schedule with chunks of a single index hands index i to thread i.
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+	for (size_t chunk = 0; chunk < num_threads; chunk++) {
+		const unsigned int thread_id = omp_get_thread_num();
+		run_chunk(first, chunks, chunk, thread_id, action);
 	}
 }
 
@@ -215,13 +520,37 @@ const char* const parallelization_library_name = "serial";
 /// Tells if a parallelization library is in use.
 const bool using_parallelization_library = false;
 
-template <typename T, typename TAction>
-void parallel_for(std::vector<T>& values, unsigned int num_threads, const TAction& action)
+template <typename TAction>
+void parallel_for_range(std::size_t first, std::size_t last, unsigned int, const TAction& action)
+{
+	serial_for_range(first, last, action);
+}
+
+template <typename TAction>
+void parallel_for_dynamic(std::size_t first, std::size_t last, unsigned int, const TAction& action)
 {
-	serial_for<T, TAction>(values, action);
+	serial_for_range(first, last, action);
+}
+
+template <typename TAction>
+void parallel_for_chunks(std::size_t first, std::size_t last, unsigned int num_threads, const TAction& action)
+{
+	num_threads = std::max(num_threads, 1U);
+	const auto chunks = CreateChunks<std::size_t>()(last - first, num_threads);
+	for (std::size_t chunk = 0; chunk < num_threads; chunk++) {
+		run_chunk(first, chunks, chunk, 0U, action);
+	}
 }
 
 #endif
+
+template <typename T, typename TAction>
+void parallel_for(std::vector<T>& values, unsigned int num_threads, const TAction& action)
+{
+	parallel_for_range(0, values.size(), num_threads, [&values, &action](std::size_t i, unsigned int thread_id) {
+		action(values[i], thread_id);
+	});
+}
 }
 }
 }
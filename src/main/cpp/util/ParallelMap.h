@@ -716,28 +716,21 @@ public:
 			}
 		}
 
-		// We now want to start a bunch of threads.
-		std::vector<std::thread> thread_pool;
-		for (std::size_t i = 0; i < chunks.size(); i++) {
-			auto start_iterator = start_iterators[i];
-			auto end_iterator = i == chunks.size() - 1 ? vals.end() : start_iterators[i + 1];
-
-			// Only start jobs if we know that they're non-empty.
-			if (start_iterator != vals.end() && start_iterator != end_iterator) {
-				thread_pool.emplace_back([this, &action, i, start_iterator, end_iterator] {
-					std::shared_lock<shared_mutex_type> read_lock{parallel_iter_mutex};
-					for (auto it = start_iterator; it != end_iterator; it++) {
-						auto& elem = *it;
-						action(elem.first, elem.second, i);
-					}
-				});
-			}
-		}
-
-		// Wait for the threads to finish.
-		for (auto& thread : thread_pool) {
-			thread.join();
-		}
+		// Now run the chunks on the threads of the parallelization library.
+		::stride::util::parallel::parallel_for_range(
+		    0, chunks.size(), num_threads, [this, &action, &start_iterators](std::size_t i, unsigned int) {
+			    auto start_iterator = start_iterators[i];
+			    auto end_iterator = i == start_iterators.size() - 1 ? vals.end() : start_iterators[i + 1];
+
+			    // Only lock the map if the chunk is non-empty.
+			    if (start_iterator != vals.end() && start_iterator != end_iterator) {
+				    std::shared_lock<shared_mutex_type> read_lock{parallel_iter_mutex};
+				    for (auto it = start_iterator; it != end_iterator; it++) {
+					    auto& elem = *it;
+					    action(elem.first, elem.second, static_cast<unsigned int>(i));
+				    }
+			    }
+		    });
 	}
 
 	/// Applies the given action to each element in this map.
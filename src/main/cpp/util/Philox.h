@@ -0,0 +1,136 @@
+#ifndef PHILOX_H_INCLUDED
+#define PHILOX_H_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace stride {
+namespace util {
+
+/**
+ * The Philox4x32-10 counter-based random number generator (Salmon et al., "Parallel random numbers:
+ * as easy as 1, 2, 3", SC 2011). It is a keyed bijection of 128-bit counters: every counter value
+ * maps to four independent random words, so any stream can be entered at any position without
+ * generating the numbers before it.
+ */
+class Philox4x32
+{
+public:
+	using Counter = std::array<std::uint32_t, 4>;
+	using Key = std::array<std::uint32_t, 2>;
+
+	/// Get the random words for the given counter and key.
+	static Counter Generate(Counter counter, Key key)
+	{
+		for (unsigned int round = 0; round < 10; round++) {
+			if (round > 0) {
+				key[0] += g_weyl_0;
+				key[1] += g_weyl_1;
+			}
+			const std::uint64_t product_0 = static_cast<std::uint64_t>(g_multiplier_0) * counter[0];
+			const std::uint64_t product_1 = static_cast<std::uint64_t>(g_multiplier_1) * counter[2];
+			counter = {{static_cast<std::uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0],
+				    static_cast<std::uint32_t>(product_1),
+				    static_cast<std::uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1],
+				    static_cast<std::uint32_t>(product_0)}};
+		}
+		return counter;
+	}
+
+	/// Get a double in [0, 1) from a random word; it is a multiple of 2^-32. Only 32 of the 52 bits
+	/// of the mantissa are random, so a trial `ToDouble(word) < p` succeeds with p rounded up to a
+	/// multiple of 2^-32. That is ample for the probabilities of contact and transmission, and it
+	/// takes one word per draw instead of two.
+	static double ToDouble(std::uint32_t word)
+	{
+		const std::uint64_t bits = (static_cast<std::uint64_t>(word) << 20) | g_one_bits;
+		double result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result - 1.0;
+	}
+
+	/// Writes a double in [0, 1) for each word of num_blocks consecutive counters, starting at the
+	/// given counter and incrementing its first word, to the given array.
+	static void GenerateDoubles(const Counter& counter, const Key& key, std::size_t num_blocks, double* out)
+	{
+		std::size_t block = 0;
+#ifdef __AVX2__
+		// Four counters at a time, one per 64-bit lane; the words are kept in the low halves.
+		const __m256i low_words = _mm256_set1_epi64x(0xFFFFFFFFLL);
+		const __m256i multiplier_0 = _mm256_set1_epi64x(g_multiplier_0);
+		const __m256i multiplier_1 = _mm256_set1_epi64x(g_multiplier_1);
+		for (; block + 4 <= num_blocks; block += 4) {
+			const auto first = static_cast<long long>(counter[0]) + static_cast<long long>(block);
+			__m256i c0 = _mm256_and_si256(
+			    _mm256_add_epi64(_mm256_set1_epi64x(first), _mm256_set_epi64x(3, 2, 1, 0)), low_words);
+			__m256i c1 = _mm256_set1_epi64x(counter[1]);
+			__m256i c2 = _mm256_set1_epi64x(counter[2]);
+			__m256i c3 = _mm256_set1_epi64x(counter[3]);
+			Key round_key = key;
+			for (unsigned int round = 0; round < 10; round++) {
+				if (round > 0) {
+					round_key[0] += g_weyl_0;
+					round_key[1] += g_weyl_1;
+				}
+				const __m256i key_0 = _mm256_set1_epi64x(round_key[0]);
+				const __m256i key_1 = _mm256_set1_epi64x(round_key[1]);
+				const __m256i product_0 = _mm256_mul_epu32(c0, multiplier_0);
+				const __m256i product_1 = _mm256_mul_epu32(c2, multiplier_1);
+				c0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(product_1, 32), c1), key_0);
+				c1 = _mm256_and_si256(product_1, low_words);
+				c2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(product_0, 32), c3), key_1);
+				c3 = _mm256_and_si256(product_0, low_words);
+			}
+			// Transpose, so that the words of a counter are stored next to each other.
+			const __m256d d0 = ToDoubles(c0);
+			const __m256d d1 = ToDoubles(c1);
+			const __m256d d2 = ToDoubles(c2);
+			const __m256d d3 = ToDoubles(c3);
+			const __m256d t0 = _mm256_unpacklo_pd(d0, d1);
+			const __m256d t1 = _mm256_unpackhi_pd(d0, d1);
+			const __m256d t2 = _mm256_unpacklo_pd(d2, d3);
+			const __m256d t3 = _mm256_unpackhi_pd(d2, d3);
+			_mm256_storeu_pd(out + 4 * block, _mm256_permute2f128_pd(t0, t2, 0x20));
+			_mm256_storeu_pd(out + 4 * block + 4, _mm256_permute2f128_pd(t1, t3, 0x20));
+			_mm256_storeu_pd(out + 4 * block + 8, _mm256_permute2f128_pd(t0, t2, 0x31));
+			_mm256_storeu_pd(out + 4 * block + 12, _mm256_permute2f128_pd(t1, t3, 0x31));
+		}
+#endif
+		for (; block < num_blocks; block++) {
+			Counter block_counter = counter;
+			block_counter[0] += static_cast<std::uint32_t>(block);
+			const auto words = Generate(block_counter, key);
+			for (std::size_t i = 0; i < words.size(); i++) {
+				out[4 * block + i] = ToDouble(words[i]);
+			}
+		}
+	}
+
+private:
+	static constexpr std::uint32_t g_multiplier_0 = 0xD2511F53U;
+	static constexpr std::uint32_t g_multiplier_1 = 0xCD9E8D57U;
+	static constexpr std::uint32_t g_weyl_0 = 0x9E3779B9U;
+	static constexpr std::uint32_t g_weyl_1 = 0xBB67AE85U;
+	static constexpr std::uint64_t g_one_bits = 0x3FF0000000000000ULL;
+
+#ifdef __AVX2__
+	/// Same as ToDouble, for the words in the low halves of four 64-bit lanes.
+	static __m256d ToDoubles(__m256i words)
+	{
+		const __m256i one_bits = _mm256_set1_epi64x(static_cast<long long>(g_one_bits));
+		const __m256i bits = _mm256_or_si256(_mm256_slli_epi64(words, 20), one_bits);
+		return _mm256_sub_pd(_mm256_castsi256_pd(bits), _mm256_set1_pd(1.0));
+	}
+#endif
+};
+
+} // namespace util
+} // namespace stride
+
+#endif // end-of-include-guard
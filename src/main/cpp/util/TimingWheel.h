@@ -0,0 +1,81 @@
+#ifndef TIMING_WHEEL_H_INCLUDED
+#define TIMING_WHEEL_H_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+namespace stride {
+namespace util {
+
+/**
+ * Schedules items on future days. The items of the next days are kept in a ring of buckets,
+ * one bucket per day, which grows when an item is scheduled beyond its horizon. Scheduling
+ * an item and retrieving the items of a day take constant time. The ring is only allocated
+ * when the first item is scheduled.
+ */
+template <typename T>
+class TimingWheel
+{
+public:
+	/// Creates an empty wheel that is at day 0.
+	TimingWheel() : m_day(0U) {}
+
+	/// Get the current day.
+	unsigned int GetDay() const { return m_day; }
+
+	/// Schedules an item on the given day, which must be later than the current day.
+	void Schedule(unsigned int day, const T& item)
+	{
+		if (m_buckets.empty()) {
+			m_buckets.resize(8U);
+		}
+		while (day - m_day >= m_buckets.size()) {
+			Grow();
+		}
+		m_buckets[day % m_buckets.size()].emplace_back(item);
+	}
+
+	/// Moves on to the next day and returns the items that were scheduled on it. The
+	/// returned items remain valid until the next call.
+	std::vector<T>& Advance()
+	{
+		m_day++;
+		m_due.clear();
+		if (!m_buckets.empty()) {
+			m_due.swap(m_buckets[m_day % m_buckets.size()]);
+		}
+		return m_due;
+	}
+
+	/// Get the number of bytes allocated by this wheel.
+	std::size_t GetMemoryUsage() const
+	{
+		std::size_t result = m_buckets.capacity() * sizeof(std::vector<T>) + m_due.capacity() * sizeof(T);
+		for (const auto& bucket : m_buckets) {
+			result += bucket.capacity() * sizeof(T);
+		}
+		return result;
+	}
+
+private:
+	/// Doubles the number of buckets, moving every item to the bucket of its day.
+	void Grow()
+	{
+		std::vector<std::vector<T>> buckets(2 * m_buckets.size());
+		for (std::size_t offset = 1; offset < m_buckets.size(); offset++) {
+			const unsigned int day = m_day + offset;
+			buckets[day % buckets.size()].swap(m_buckets[day % m_buckets.size()]);
+		}
+		m_buckets.swap(buckets);
+	}
+
+private:
+	unsigned int m_day;
+	std::vector<std::vector<T>> m_buckets;
+	std::vector<T> m_due;
+};
+
+} // namespace util
+} // namespace stride
+
+#endif // end-of-include-guard
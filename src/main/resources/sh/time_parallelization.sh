@@ -70,6 +70,28 @@ do
 done
 popd
 
+make clean
+export STRIDE_PARALLELIZATION_LIBRARY=PSTL
+make
+make install_test
+pushd build/installed
+echo "# small-pstl" >> ../../measurements.txt
+for i in `seq 1 10`;
+do
+    run-and-time config/run_popgen_small.xml >> ../../measurements.txt
+done
+echo "# medium-pstl" >> ../../measurements.txt
+for i in `seq 1 10`;
+do
+    run-and-time config/run_popgen_medium.xml >> ../../measurements.txt
+done
+echo "# large-pstl" >> ../../measurements.txt
+for i in `seq 1 10`;
+do
+    run-and-time config/run_popgen_large.xml >> ../../measurements.txt
+done
+popd
+
 make clean
 export STRIDE_PARALLELIZATION_LIBRARY=none
 make
@@ -21,4 +21,39 @@ TEST(Alias, Next)
 	Alias::CreateDistribution({1.0}, rng).Next();
 }
 
+TEST(Alias, NextFollowsProbabilities)
+{
+	stride::util::Random rng(0);
+	auto alias = Alias::CreateDistribution({4.0, 1.0, 2.0, 1.0}, rng);
+	std::vector<int> counts(4U, 0);
+	const int num_samples = 80000;
+	for (int i = 0; i < num_samples; i++) {
+		counts[alias.Next()]++;
+	}
+	EXPECT_NEAR(counts[0], num_samples / 2, num_samples / 100);
+	EXPECT_NEAR(counts[1], num_samples / 8, num_samples / 100);
+	EXPECT_NEAR(counts[2], num_samples / 4, num_samples / 100);
+	EXPECT_NEAR(counts[3], num_samples / 8, num_samples / 100);
+}
+
+TEST(Alias, NextNMatchesNext)
+{
+	std::vector<double> probabilities;
+	for (int i = 0; i < 100000; i++) {
+		probabilities.push_back(1.0 + i % 7);
+	}
+	stride::util::Random batch_rng(3);
+	stride::util::Random single_rng(3);
+	auto batch_alias = Alias::CreateDistribution(probabilities, batch_rng);
+	auto single_alias = Alias::CreateDistribution(probabilities, single_rng);
+
+	std::vector<std::size_t> values{42U};
+	batch_alias.NextN(1000U, values);
+	ASSERT_EQ(values.size(), 1001U);
+	ASSERT_EQ(values[0], 42U);
+	for (std::size_t i = 1; i < values.size(); i++) {
+		ASSERT_EQ(values[i], single_alias.Next());
+	}
+}
+
 } // Tests
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <core/Cluster.h>
+#include <core/ClusterType.h>
+#include <core/ContactProbabilities.h>
+#include <core/ContactProfile.h>
+#include <gtest/gtest.h>
+#include <pop/Population.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace stride;
+
+namespace Tests {
+
+TEST(Cluster, InfectiousCount)
+{
+	Population population;
+	const disease::Fate fate{1, 100, 100, 100};
+	for (unsigned int i = 1; i <= 3; i++) {
+		population.emplace(i, 30.0, 1, 0, 0, 0, 0, fate);
+	}
+	const auto infectious = population.getPerson(1);
+	infectious.StartInfection();
+	std::vector<PersonIndex> infectiousness_changes;
+	population.get_store().AdvanceDay(infectiousness_changes);
+	ASSERT_TRUE(infectious.GetHealth().IsInfectious());
+
+	Cluster cluster(1, ClusterType::Household);
+	population.serial_for([&cluster](const Person& p, unsigned int) { cluster.AddPerson(p); });
+	EXPECT_EQ(1U, cluster.GetInfectiousCount());
+
+	cluster.UpdateInfectiousCount(true);
+	EXPECT_EQ(2U, cluster.GetInfectiousCount());
+	cluster.UpdateInfectiousCount(false);
+
+	cluster.RemovePerson(population.getPerson(2));
+	EXPECT_EQ(1U, cluster.GetInfectiousCount());
+	cluster.RemovePerson(infectious);
+	EXPECT_EQ(0U, cluster.GetInfectiousCount());
+	EXPECT_EQ(1U, cluster.GetSize());
+}
+
+TEST(Cluster, Partitions)
+{
+	Population population;
+	const disease::Fate fate{1, 100, 100, 100};
+	for (unsigned int i = 1; i <= 8; i++) {
+		population.emplace(i, 30.0, 0, 0, 0, 1, 0, fate);
+	}
+	for (const PersonId id : {2U, 5U}) {
+		population.getPerson(id).SetImmune();
+	}
+	population.getPerson(4).StartInfection();
+
+	// Members are kept in the order: cases, susceptible, immune.
+	auto is_partitioned = [](const Cluster& cluster) {
+		unsigned int last_rank = 0;
+		for (const auto& p : cluster.GetPeople()) {
+			const auto health = p.GetHealth();
+			const unsigned int rank = health.IsImmune() ? 2 : health.IsSusceptible() ? 1 : 0;
+			if (rank < last_rank) {
+				return false;
+			}
+			last_rank = rank;
+		}
+		return true;
+	};
+	Cluster cluster(1, ClusterType::PrimaryCommunity);
+	population.serial_for([&cluster](const Person& p, unsigned int) { cluster.AddPerson(p); });
+	EXPECT_TRUE(is_partitioned(cluster));
+
+	for (const PersonId id : {1U, 8U, 6U}) {
+		population.getPerson(id).StartInfection();
+		cluster.UpdateMemberStatus(population.getPerson(id).GetIndex());
+		EXPECT_TRUE(is_partitioned(cluster));
+	}
+	for (const PersonId id : {2U, 8U, 3U, 4U}) {
+		cluster.RemovePerson(population.getPerson(id));
+		EXPECT_TRUE(is_partitioned(cluster));
+	}
+	EXPECT_EQ(4U, cluster.GetSize());
+	cluster.RemovePerson(population.getPerson(3));
+	EXPECT_EQ(4U, cluster.GetSize());
+
+	// A member is found outside the partition of its health status as well.
+	population.getPerson(7).SetImmune();
+	cluster.RemovePerson(population.getPerson(7));
+	EXPECT_EQ(3U, cluster.GetSize());
+}
+
+TEST(Cluster, ContactProbabilities)
+{
+	Population population;
+	const disease::Fate fate{1, 100, 100, 100};
+	for (unsigned int i = 1; i <= 6; i++) {
+		population.emplace(i, i < 4 ? 10.0 : 40.0, 0, 0, 1, 0, 0, fate);
+	}
+	ContactProfile profile;
+	profile.fill(2.0);
+	profile[10] = 4.0;
+	Cluster::AddContactProfile(ClusterType::Work, profile);
+
+	ContactProbabilityTable table;
+	table.SetTransmissionRate(0.5);
+	Cluster cluster1(1, ClusterType::Work);
+	Cluster cluster2(2, ClusterType::Work);
+	population.serial_for([&cluster1, &cluster2](const Person& p, unsigned int) {
+		(p.GetId() % 2 == 1 ? cluster1 : cluster2).AddPerson(p);
+	});
+	cluster1.UpdateContactProbabilities(table);
+	cluster2.UpdateContactProbabilities(table);
+
+	// Clusters of the same type and size share their probabilities.
+	const auto& probabilities = cluster1.GetContactProbabilities();
+	EXPECT_EQ(&probabilities, &cluster2.GetContactProbabilities());
+	EXPECT_DOUBLE_EQ(1 - std::exp(-4.0 / 3), probabilities.contact[cluster1.GetEffectiveAge(0)]);
+	EXPECT_DOUBLE_EQ(1 - std::exp(-2.0 / 3), probabilities.contact[40]);
+	EXPECT_DOUBLE_EQ(1 - std::exp(-0.5 * 4.0 / 3), probabilities.contact_and_transmission[10]);
+	EXPECT_DOUBLE_EQ(1 - std::exp(-0.5), probabilities.transmission);
+
+	// A new transmission rate or a new size gives new probabilities.
+	cluster1.RemovePerson(population.getPerson(1));
+	cluster1.UpdateContactProbabilities(table);
+	EXPECT_DOUBLE_EQ(1 - std::exp(-2.0 / 2), cluster1.GetContactProbabilities().contact[40]);
+	table.SetTransmissionRate(1.0);
+	cluster2.UpdateContactProbabilities(table);
+	EXPECT_DOUBLE_EQ(1 - std::exp(-4.0 / 3), cluster2.GetContactProbabilities().contact_and_transmission[10]);
+}
+
+} // Tests
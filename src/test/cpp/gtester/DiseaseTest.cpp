@@ -0,0 +1,50 @@
+#include <vector>
+#include <gtest/gtest.h>
+#include "core/Disease.h"
+#include "util/Random.h"
+
+using namespace stride::disease;
+
+namespace Tests {
+
+TEST(Disease, DistributionFollowsProbabilities)
+{
+	// The cumulative sum of {0.5, 0, 0.25, 0.25}.
+	const Distribution distribution({0.5, 0.5, 0.75, 1.0});
+	stride::util::Random rng(0);
+	std::vector<int> counts(4U, 0);
+	const int num_samples = 80000;
+	for (int i = 0; i < num_samples; i++) {
+		counts[distribution.Sample(rng)]++;
+	}
+	EXPECT_NEAR(counts[0], num_samples / 2, num_samples / 100);
+	EXPECT_EQ(counts[1], 0);
+	EXPECT_NEAR(counts[2], num_samples / 4, num_samples / 100);
+	EXPECT_NEAR(counts[3], num_samples / 4, num_samples / 100);
+}
+
+TEST(Disease, SampleManyDoesNotDependOnThreads)
+{
+	const Disease disease(
+	    Distribution({0.2, 0.6, 1.0}), Distribution({0.5, 1.0}), Distribution({0.1, 0.3, 0.7, 1.0}),
+	    Distribution({1.0}));
+	const std::size_t count = 10000U;
+
+	stride::util::Random serial_rng(5);
+	std::vector<Fate> serial(count);
+	disease.SampleMany(serial_rng, serial.data(), count, 1U);
+	stride::util::Random parallel_rng(5);
+	std::vector<Fate> parallel(count);
+	disease.SampleMany(parallel_rng, parallel.data(), count, 4U);
+
+	for (std::size_t i = 0; i < count; i++) {
+		ASSERT_EQ(serial[i].start_infectiousness, parallel[i].start_infectiousness);
+		ASSERT_EQ(serial[i].start_symptomatic, parallel[i].start_symptomatic);
+		ASSERT_EQ(serial[i].end_infectiousness, parallel[i].end_infectiousness);
+		ASSERT_EQ(serial[i].end_symptomatic, parallel[i].end_symptomatic);
+		ASSERT_LE(serial[i].start_infectiousness, serial[i].end_infectiousness);
+	}
+	ASSERT_EQ(serial_rng.NextDouble(), parallel_rng.NextDouble());
+}
+
+} // Tests
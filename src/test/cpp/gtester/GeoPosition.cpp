@@ -1,5 +1,9 @@
+#include <functional>
 #include <iostream>
+#include <map>
+#include <random>
 #include <vector>
+#include <geo/GeoGrid.h>
 #include <geo/GeoPosition.h>
 #include <gtest/gtest.h>
 
@@ -13,4 +17,75 @@ TEST(GeoPosition, SampleCalculation)
 	ASSERT_NEAR(amsterdam.Distance(paris), 429.7, 1.0);
 }
 
+TEST(GeoPosition, HullSamplerIsUniform)
+{
+	using namespace stride::geo;
+	// A square of area 4 with a triangle of area 1 on one side, and a point inside.
+	const std::vector<GeoPosition> points{{0.0, 0.0}, {0.0, 2.0}, {2.0, 2.0}, {2.0, 0.0}, {3.0, 1.0}, {1.0, 1.0}};
+	GeoPolygon hull;
+	boost::geometry::convex_hull(points, hull);
+	const HullSampler sampler(points);
+
+	stride::util::Random random(42);
+	const int num_samples = 100000;
+	int in_triangle = 0;
+	for (int i = 0; i < num_samples; i++) {
+		const auto position = sampler.Sample(random);
+		ASSERT_TRUE(boost::geometry::covered_by(position, hull)) << position.ToString();
+		in_triangle += position.latitude > 2.0;
+	}
+	EXPECT_NEAR(static_cast<double>(in_triangle) / num_samples, 0.2, 0.01);
+
+	// Drawing many positions at once gives the same positions as drawing them one by one.
+	stride::util::Random batch_random(7);
+	stride::util::Random single_random(7);
+	std::vector<GeoPosition> positions;
+	sampler.Sample(batch_random, 100, positions);
+	ASSERT_EQ(positions.size(), 100U);
+	for (const auto& position : positions) {
+		const auto expected = sampler.Sample(single_random);
+		ASSERT_EQ(expected.latitude, position.latitude);
+		ASSERT_EQ(expected.longitude, position.longitude);
+	}
+}
+
+TEST(GeoPosition, GridFindsSameAsScan)
+{
+	using namespace stride::geo;
+	std::mt19937 engine(1234U);
+	std::uniform_real_distribution<double> latitude(-89.0, 89.0);
+	std::uniform_real_distribution<double> longitude(-180.0, 180.0);
+	std::map<GeoPosition, int> map;
+	for (int i = 0; i < 2000; i++) {
+		map[GeoPosition{latitude(engine), longitude(engine)}] = i;
+	}
+	// A dense cluster of positions, with some right on either side of the antimeridian.
+	for (int i = 0; i < 500; i++) {
+		map[GeoPosition{latitude(engine) / 100.0 + 50.0, longitude(engine) / 1000.0}] = i;
+		map[GeoPosition{latitude(engine) / 100.0 - 20.0, 179.9 + longitude(engine) / 1800.0}] = i;
+	}
+
+	const GeoGrid<int> grid(map, 10.0);
+	std::vector<GeoPosition> origins{{50.0, 0.0}, {-20.0, 180.0}, {-20.0, -179.95}, {88.9, 10.0}, {-89.0, 0.0}};
+	for (int i = 0; i < 200; i++) {
+		origins.push_back(GeoPosition{latitude(engine), longitude(engine)});
+	}
+	for (const auto& origin : origins) {
+		for (const double radius : {1.0, 10.0, 100.0, 1000.0, 10000.0}) {
+			std::vector<std::reference_wrapper<int>> expected;
+			for (auto& p : map) {
+				if (p.first.Distance(origin) < radius) {
+					expected.emplace_back(p.second);
+				}
+			}
+			std::vector<std::reference_wrapper<int>> hits;
+			grid.FindWithin(origin, radius, hits);
+			ASSERT_EQ(expected.size(), hits.size()) << origin.ToString() << " within " << radius;
+			for (std::size_t i = 0; i < hits.size(); i++) {
+				ASSERT_EQ(&expected[i].get(), &hits[i].get());
+			}
+		}
+	}
+}
+
 } // Tests
\ No newline at end of file
@@ -0,0 +1,403 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <boost/property_tree/ptree.hpp>
+#include <core/Cluster.h>
+#include <core/ContactProbabilities.h>
+#include <core/ContactProfile.h>
+#include <core/DiseaseProfile.h>
+#include <core/Infector.h>
+#include <core/RngHandler.h>
+#include <core/TransmissionKernel.h>
+#include <gtest/gtest.h>
+#include <pop/Population.h>
+#include <sim/SimulationConfig.h>
+#include <util/Philox.h>
+
+using namespace stride;
+
+namespace Tests {
+
+namespace {
+
+/// Moves on to the next day in the disease of every person in the population.
+void AdvanceDay(Population& population)
+{
+	std::vector<PersonIndex> infectiousness_changes;
+	population.get_store().AdvanceDay(infectiousness_changes);
+}
+
+/// Number of susceptible members in the test cluster.
+const unsigned int g_num_susceptible = 400U;
+
+/// Builds a population with one infectious person and g_num_susceptible susceptible
+/// persons, all members of school cluster 1. Every other susceptible person is a
+/// child that stays home today.
+Population CreatePopulation()
+{
+	Population population;
+	const disease::Fate fate{1, 100, 100, 100};
+	population.emplace(1, 30.0, 1, 1, 0, 0, 0, fate);
+	for (unsigned int i = 0; i < g_num_susceptible; i++) {
+		population.emplace(i + 2, i % 2 == 0 ? 30.0 : 10.0, 1, 1, 0, 0, 0, fate);
+	}
+	const auto index_case = population.getPerson(1);
+	index_case.StartInfection();
+	AdvanceDay(population);
+	population.get_store().UpdatePresence(false, true);
+	return population;
+}
+
+/// Runs the infector on a fresh cluster for the given number of trials and returns
+/// the mean and variance of the number of transmissions. With more than one thread,
+/// the cluster is divided over the threads.
+std::pair<double, double> SampleTransmissions(
+    TransmissionKernel kernel, unsigned int num_trials, unsigned int seed, unsigned int num_threads = 1U)
+{
+	ContactProfile profile;
+	profile.fill(40.0);
+	Cluster::AddContactProfile(ClusterType::School, profile);
+
+	DiseaseProfile disease_profile;
+	SingleSimulationConfig config;
+	config.common_config = std::make_shared<CommonSimulationConfig>();
+	config.common_config->r0 = 0.5;
+	boost::property_tree::ptree pt_disease;
+	pt_disease.put("disease.transmission.b0", 0.0);
+	pt_disease.put("disease.transmission.b1", 1.0);
+	disease_profile.Initialize(config, pt_disease);
+
+	ContactProbabilityTable probabilities;
+	probabilities.SetTransmissionRate(disease_profile.GetTransmissionRate());
+	std::vector<RngHandler> rngs(num_threads, RngHandler(seed));
+	std::vector<std::vector<Transmission>> transmissions(num_threads);
+	double sum = 0.0;
+	double sum_of_squares = 0.0;
+	for (unsigned int trial = 0; trial < num_trials; trial++) {
+		auto population = CreatePopulation();
+		Cluster cluster(1, ClusterType::School);
+		population.serial_for([&cluster](const Person& p, unsigned int) { cluster.AddPerson(p); });
+		cluster.UpdateContactProbabilities(probabilities);
+		for (auto& rng : rngs) {
+			rng.SetDay(trial);
+		}
+		for (auto& buffer : transmissions) {
+			buffer.clear();
+		}
+		if (num_threads > 1) {
+			Infector<LogMode::None, false, NoLocalInformation>::ExecuteSplit(
+			    cluster, disease_profile, rngs, transmissions, num_threads, nullptr, nullptr, kernel);
+			for (unsigned int i = 1; i < num_threads; i++) {
+				transmissions[0].insert(
+				    transmissions[0].end(), transmissions[i].begin(), transmissions[i].end());
+			}
+		} else {
+			Infector<LogMode::None, false, NoLocalInformation>::Execute(
+			    cluster, disease_profile, rngs[0], transmissions[0], nullptr, nullptr, kernel);
+		}
+		Infector<LogMode::None, false, NoLocalInformation>::StartInfections(
+		    population.get_store(), transmissions[0], nullptr, nullptr);
+		for (const auto& p : population) {
+			// Children stay home and cannot be infected.
+			EXPECT_TRUE(p.GetAge() > 18 || p.GetHealth().IsSusceptible());
+		}
+		const double transmissions = population.get_infected_count() - 1.0;
+		sum += transmissions;
+		sum_of_squares += transmissions * transmissions;
+	}
+	const double mean = sum / num_trials;
+	return std::make_pair(mean, sum_of_squares / num_trials - mean * mean);
+}
+
+} // namespace
+
+TEST(Infector, SkipSamplingMatchesPairwise)
+{
+	const unsigned int num_trials = 2000U;
+	const unsigned int num_present = g_num_susceptible / 2;
+	const double probability = 1.0 - std::exp(-0.5 * 40.0 / (g_num_susceptible + 1));
+	const double expected_mean = num_present * probability;
+	const double expected_variance = num_present * probability * (1.0 - probability);
+	const double standard_error = std::sqrt(expected_variance / num_trials);
+
+	const auto pairwise = SampleTransmissions(TransmissionKernel::Pairwise, num_trials, 1U);
+	const auto skip_sampling = SampleTransmissions(TransmissionKernel::SkipSampling, num_trials, 2U);
+
+	// Both kernels sample Binomial(num_present, probability) transmissions.
+	EXPECT_NEAR(expected_mean, pairwise.first, 5 * standard_error);
+	EXPECT_NEAR(expected_mean, skip_sampling.first, 5 * standard_error);
+	EXPECT_NEAR(pairwise.first, skip_sampling.first, 5 * std::sqrt(2.0) * standard_error);
+	EXPECT_NEAR(expected_variance, pairwise.second, 0.2 * expected_variance);
+	EXPECT_NEAR(expected_variance, skip_sampling.second, 0.2 * expected_variance);
+}
+
+TEST(Infector, MeanFieldMatchesPairwise)
+{
+	// Members of two ages with different contact rates are infectious. A present susceptible member
+	// escapes all of them with probability exp(-transmission_rate * sum of their rates / size).
+	ContactProfile profile;
+	profile.fill(20.0);
+	profile[10] = 60.0;
+	Cluster::AddContactProfile(ClusterType::Work, profile);
+
+	DiseaseProfile disease_profile;
+	SingleSimulationConfig config;
+	config.common_config = std::make_shared<CommonSimulationConfig>();
+	config.common_config->r0 = 0.1;
+	boost::property_tree::ptree pt_disease;
+	pt_disease.put("disease.transmission.b0", 0.0);
+	pt_disease.put("disease.transmission.b1", 1.0);
+	disease_profile.Initialize(config, pt_disease);
+	ContactProbabilityTable probabilities;
+	probabilities.SetTransmissionRate(disease_profile.GetTransmissionRate());
+
+	const unsigned int num_infectious = 20U;
+	const unsigned int size = 320U;
+	const unsigned int num_trials = 200U;
+	std::vector<double> means;
+	for (const auto kernel : {TransmissionKernel::Pairwise, TransmissionKernel::MeanField}) {
+		Population population;
+		const disease::Fate fate{1, 100, 100, 100};
+		for (unsigned int i = 0; i < size; i++) {
+			population.emplace(i + 1, i < num_infectious && i % 2 == 0 ? 10.0 : 30.0, 0, 0, 1, 0, 0, fate);
+		}
+		for (PersonId id = 1; id <= num_infectious; id++) {
+			population.getPerson(id).StartInfection();
+		}
+		AdvanceDay(population);
+		Cluster cluster(1, ClusterType::Work);
+		population.serial_for([&cluster](const Person& p, unsigned int) { cluster.AddPerson(p); });
+		cluster.UpdateContactProbabilities(probabilities);
+
+		RngHandler rng(11);
+		std::vector<Transmission> transmissions;
+		double sum = 0.0;
+		for (unsigned int trial = 0; trial < num_trials; trial++) {
+			rng.SetDay(trial);
+			transmissions.clear();
+			Infector<LogMode::None, false, NoLocalInformation>::Execute(
+			    cluster, disease_profile, rng, transmissions, nullptr, nullptr, kernel);
+			std::vector<PersonIndex> infected;
+			for (const auto& transmission : transmissions) {
+				EXPECT_LT(transmission.infector, num_infectious);
+				EXPECT_GE(transmission.infected, num_infectious);
+				infected.push_back(transmission.infected);
+			}
+			std::sort(infected.begin(), infected.end());
+			sum += std::unique(infected.begin(), infected.end()) - infected.begin();
+		}
+		means.push_back(sum / num_trials);
+	}
+
+	const double rate = 0.1 * (num_infectious / 2 * 60.0 + num_infectious / 2 * 20.0) / size;
+	const double probability = 1.0 - std::exp(-rate);
+	const unsigned int num_susceptible = size - num_infectious;
+	const double standard_error = std::sqrt(num_susceptible * probability * (1.0 - probability) / num_trials);
+	EXPECT_NEAR(num_susceptible * probability, means[0], 5 * standard_error);
+	EXPECT_NEAR(num_susceptible * probability, means[1], 5 * standard_error);
+}
+
+TEST(Infector, SplitMatchesWholeCluster)
+{
+	const unsigned int num_trials = 1000U;
+	const unsigned int num_present = g_num_susceptible / 2;
+	const double probability = 1.0 - std::exp(-0.5 * 40.0 / (g_num_susceptible + 1));
+	const double standard_error = std::sqrt(probability * (1.0 - probability) * num_present / num_trials);
+
+	const auto pairwise = SampleTransmissions(TransmissionKernel::Pairwise, num_trials, 3U, 4U);
+	const auto skip_sampling = SampleTransmissions(TransmissionKernel::SkipSampling, num_trials, 4U, 4U);
+	EXPECT_NEAR(num_present * probability, pairwise.first, 5 * standard_error);
+	EXPECT_NEAR(num_present * probability, skip_sampling.first, 5 * standard_error);
+}
+
+TEST(Infector, CounterBasedStreams)
+{
+	// Known answer of Philox4x32-10 for a zero counter and key.
+	const auto words = util::Philox4x32::Generate({{0U, 0U, 0U, 0U}}, {{0U, 0U}});
+	EXPECT_EQ(0x6627e8d5U, words[0]);
+	EXPECT_EQ(0xe169c58dU, words[1]);
+	EXPECT_EQ(0xbc57ac4cU, words[2]);
+	EXPECT_EQ(0x9b00dbd8U, words[3]);
+
+	// A stream only depends on the seed, the day, the cluster and the member.
+	RngHandler first(7);
+	RngHandler second(7);
+	second.SetStream(ClusterType::Work, 3, 11);
+	second.NextDouble();
+	first.SetDay(5);
+	second.SetDay(5);
+	first.SetStream(ClusterType::School, 3, 11);
+	second.SetStream(ClusterType::School, 3, 11);
+	std::vector<double> draws;
+	for (unsigned int i = 0; i < 20; i++) {
+		draws.push_back(first.NextDouble());
+		EXPECT_EQ(draws.back(), second.NextDouble());
+	}
+	second.SetStream(ClusterType::School, 3, 12);
+	EXPECT_NE(draws[0], second.NextDouble());
+	first.SetStream(ClusterType::School, 3, 11);
+	EXPECT_EQ(draws[0], first.NextDouble());
+}
+
+TEST(Infector, BatchedTrials)
+{
+	RngHandler single(3);
+	RngHandler batched(3);
+	single.SetStream(ClusterType::Household, 1, 2);
+	batched.SetStream(ClusterType::Household, 1, 2);
+
+	// Batches give the same doubles as single draws, also when they start mid-way a generated block.
+	std::vector<double> expected(200);
+	for (auto& value : expected) {
+		value = single.NextDouble();
+	}
+	std::vector<double> actual(expected.size());
+	actual[0] = batched.NextDouble();
+	batched.NextDoubles(&actual[1], 5);
+	batched.NextDoubles(&actual[6], 101);
+	batched.NextDoubles(&actual[107], 93);
+	EXPECT_EQ(expected, actual);
+
+	// Both are the words of the scalar generator, for the counter of the stream on day 0.
+	for (std::size_t i = 0; i < expected.size(); i++) {
+		const util::Philox4x32::Counter counter{
+		    {static_cast<std::uint32_t>(i / 4), 2U, 1U, static_cast<std::uint32_t>(ClusterType::Household)}};
+		const auto words = util::Philox4x32::Generate(counter, {{3U, 0U}});
+		ASSERT_EQ(util::Philox4x32::ToDouble(words[i % 4]), expected[i]);
+	}
+
+	single.SetStream(ClusterType::Household, 1, 3);
+	batched.SetStream(ClusterType::Household, 1, 3);
+	const auto successes = batched.NextTrials(0.25, 45);
+	for (unsigned int i = 0; i < 45; i++) {
+		EXPECT_EQ(single.Chance(0.25), ((successes >> i) & 1U) == 1U);
+	}
+	EXPECT_EQ(0U, successes >> 45);
+}
+
+TEST(Infector, SplitIsIdenticalToWholeCluster)
+{
+	// Transmissions do not depend on the number of threads the cluster is divided over.
+	for (const auto kernel :
+	     {TransmissionKernel::Pairwise, TransmissionKernel::SkipSampling, TransmissionKernel::MeanField}) {
+		std::vector<std::vector<HealthStatus>> statuses;
+		for (const unsigned int num_threads : {1U, 3U, 8U}) {
+			auto population = CreatePopulation();
+			for (PersonId id = 2; id < 30; id += 2) {
+				population.getPerson(id).StartInfection();
+			}
+			AdvanceDay(population);
+			population.get_store().UpdatePresence(false, false);
+			Cluster cluster(1, ClusterType::School);
+			population.serial_for([&cluster](const Person& p, unsigned int) { cluster.AddPerson(p); });
+
+			DiseaseProfile disease_profile;
+			SingleSimulationConfig config;
+			config.common_config = std::make_shared<CommonSimulationConfig>();
+			config.common_config->r0 = 5.0;
+			boost::property_tree::ptree pt_disease;
+			pt_disease.put("disease.transmission.b0", 0.0);
+			pt_disease.put("disease.transmission.b1", 1.0);
+			disease_profile.Initialize(config, pt_disease);
+			ContactProbabilityTable probabilities;
+			probabilities.SetTransmissionRate(disease_profile.GetTransmissionRate());
+			cluster.UpdateContactProbabilities(probabilities);
+
+			std::vector<RngHandler> rngs(num_threads, RngHandler(13));
+			std::vector<std::vector<Transmission>> transmissions(num_threads);
+			Infector<LogMode::None, false, NoLocalInformation>::ExecuteSplit(
+			    cluster, disease_profile, rngs, transmissions, num_threads, nullptr, nullptr, kernel);
+			for (unsigned int i = 1; i < num_threads; i++) {
+				transmissions[0].insert(
+				    transmissions[0].end(), transmissions[i].begin(), transmissions[i].end());
+			}
+			Infector<LogMode::None, false, NoLocalInformation>::StartInfections(
+			    population.get_store(), transmissions[0], nullptr, nullptr);
+
+			statuses.emplace_back();
+			for (const auto& p : population) {
+				statuses.back().push_back(p.GetHealth().GetHealthStatus());
+			}
+		}
+		EXPECT_LT(15, std::count(statuses[0].begin(), statuses[0].end(), HealthStatus::Exposed));
+		EXPECT_EQ(statuses[0], statuses[1]);
+		EXPECT_EQ(statuses[0], statuses[2]);
+	}
+}
+
+TEST(Infector, SmallClusters)
+{
+	// Clusters of up to 8 members have a kernel of their own. Its transmissions from the one
+	// infectious member to the susceptible members follow Binomial(num_susceptible, probability).
+	ContactProfile profile;
+	profile.fill(3.0);
+	Cluster::AddContactProfile(ClusterType::Household, profile);
+
+	DiseaseProfile disease_profile;
+	SingleSimulationConfig config;
+	config.common_config = std::make_shared<CommonSimulationConfig>();
+	config.common_config->r0 = 0.5;
+	boost::property_tree::ptree pt_disease;
+	pt_disease.put("disease.transmission.b0", 0.0);
+	pt_disease.put("disease.transmission.b1", 1.0);
+	disease_profile.Initialize(config, pt_disease);
+	ContactProbabilityTable probabilities;
+	probabilities.SetTransmissionRate(disease_profile.GetTransmissionRate());
+
+	const unsigned int num_trials = 4000U;
+	for (unsigned int size = 2; size <= 8; size++) {
+		// The last member of the larger clusters is immune.
+		Population population;
+		const disease::Fate fate{1, 100, 100, 100};
+		for (unsigned int i = 1; i <= size; i++) {
+			population.emplace(i, 30.0, 1, 0, 0, 0, 0, fate);
+		}
+		const auto index_case = population.getPerson(1);
+		index_case.StartInfection();
+		AdvanceDay(population);
+		const auto immune = population.getPerson(size);
+		if (size > 2) {
+			immune.SetImmune();
+		}
+		Cluster cluster(1, ClusterType::Household);
+		population.serial_for([&cluster](const Person& p, unsigned int) { cluster.AddPerson(p); });
+		cluster.UpdateContactProbabilities(probabilities);
+
+		RngHandler rng(size);
+		std::vector<Transmission> transmissions;
+		for (unsigned int trial = 0; trial < num_trials; trial++) {
+			rng.SetDay(trial);
+			Infector<LogMode::None, false, NoLocalInformation>::Execute(
+			    cluster, disease_profile, rng, transmissions, nullptr, nullptr);
+		}
+		for (const auto& transmission : transmissions) {
+			EXPECT_EQ(index_case.GetIndex(), transmission.infector);
+			EXPECT_NE(index_case.GetIndex(), transmission.infected);
+			EXPECT_TRUE(size == 2 || transmission.infected != immune.GetIndex());
+		}
+
+		const unsigned int num_susceptible = size > 2 ? size - 2 : 1;
+		const double probability = 1.0 - std::exp(-0.5 * 3.0 / size);
+		const double expected = num_trials * num_susceptible * probability;
+		EXPECT_NEAR(expected, transmissions.size(), 5 * std::sqrt(expected * (1.0 - probability)));
+	}
+}
+
+TEST(Infector, SkipTrials)
+{
+	RngHandler rng(42);
+	EXPECT_EQ(10U, rng.SkipTrials(0.0, 10));
+	EXPECT_EQ(0U, rng.SkipTrials(1.0, 10));
+
+	// The number of failures before the first success has mean (1 - p) / p.
+	const unsigned int num_draws = 100000U;
+	const double probability = 0.1;
+	double sum = 0.0;
+	for (unsigned int i = 0; i < num_draws; i++) {
+		sum += rng.SkipTrials(probability, 1000000);
+	}
+	EXPECT_NEAR((1.0 - probability) / probability, sum / num_draws, 0.1);
+}
+
+} // Tests
@@ -1,6 +1,10 @@
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 #include <gtest/gtest.h>
 #include "util/Parallel.h"
@@ -51,6 +55,62 @@ TEST(Parallel, VectorPseudoParallel)
 	});
 }
 
+TEST(Parallel, RangeRepeatedAndNested)
+{
+	const unsigned int num_threads = 4U;
+	std::vector<std::atomic<int>> visits(1000U);
+	for (auto& visit : visits) {
+		visit = 0;
+	}
+	std::atomic<bool> ids_valid(true);
+
+	// Many short loops in a row, as in a simulation step, each containing a nested loop. A nested
+	// loop runs with the thread id of the enclosing loop, whose per-thread data it may use.
+	for (int step = 0; step < 100; step++) {
+		stride::util::parallel::parallel_for_dynamic(
+		    0U, visits.size() / 10, num_threads, [&](std::size_t i, unsigned int thread_id) {
+			    ids_valid = ids_valid && thread_id < num_threads;
+			    stride::util::parallel::parallel_for_range(
+				10 * i, 10 * i + 10, num_threads, [&](std::size_t j, unsigned int nested_id) {
+					ids_valid = ids_valid && nested_id == thread_id;
+					visits[j]++;
+				});
+		    });
+	}
+	EXPECT_TRUE(ids_valid);
+	for (auto& visit : visits) {
+		ASSERT_EQ(visit, 100);
+	}
+}
+
+TEST(Parallel, Chunks)
+{
+	// The chunks are those of CreateChunks, each on a thread id of its own.
+	const unsigned int num_threads = 4U;
+	const std::size_t first = 7U;
+	const std::size_t last = 1010U;
+	std::mutex mutex;
+	std::vector<std::pair<std::size_t, std::size_t>> actual;
+	std::vector<unsigned int> thread_ids;
+	stride::util::parallel::parallel_for_chunks(
+	    first, last, num_threads, [&](std::size_t begin, std::size_t end, unsigned int thread_id) {
+		    std::lock_guard<std::mutex> lock(mutex);
+		    actual.emplace_back(begin, end);
+		    thread_ids.push_back(thread_id);
+	    });
+
+	const auto chunks = stride::util::parallel::CreateChunks<std::size_t>()(last - first, num_threads);
+	std::vector<std::pair<std::size_t, std::size_t>> expected;
+	for (std::size_t chunk = 0; chunk < num_threads; chunk++) {
+		expected.emplace_back(first + (chunk == 0 ? 0 : chunks[chunk - 1]), first + chunks[chunk]);
+	}
+	std::sort(actual.begin(), actual.end());
+	EXPECT_EQ(expected, actual);
+	for (auto thread_id : thread_ids) {
+		EXPECT_LT(thread_id, num_threads);
+	}
+}
+
 template <typename K, typename V>
 using MapActionType = std::function<void(const K& key, V& val, unsigned int thread_number)>;
 
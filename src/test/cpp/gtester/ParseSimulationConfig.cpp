@@ -4,7 +4,9 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <gtest/gtest.h>
+#include "core/ClusterType.h"
 #include "core/LogMode.h"
+#include "core/TransmissionKernel.h"
 #include "sim/SimulationConfig.h"
 
 namespace Tests {
@@ -53,6 +55,38 @@ TEST(ParseSimulationConfig, ParseDefaultSimulationConfig)
 	EXPECT_EQ(config.log_config->log_level, stride::LogMode::Transmissions);
 }
 
+TEST(ParseSimulationConfig, ParseTransmissionKernels)
+{
+	std::ifstream pop_file{"../config/run_default.xml"};
+	boost::property_tree::ptree pt;
+	boost::property_tree::read_xml(pop_file, pt);
+	pt.put("run.transmission_kernel.work", "MeanField");
+	pt.put("run.transmission_kernel.work.<xmlattr>.fallback", "SkipSampling");
+	pt.put("run.transmission_kernel.school", "MeanField");
+	pt.put("run.transmission_kernel.household", "SkipSampling");
+	stride::MultiSimulationConfig config;
+	config.Parse(pt.get_child("run"));
+
+	// The mean field kernel falls back to the configured kernel or to the pairwise kernel.
+	const auto& kernels = config.common_config->transmission_kernels;
+	const auto& small_cluster_kernels = config.common_config->small_cluster_kernels;
+	const auto work = stride::ToSizeType(stride::ClusterType::Work);
+	const auto school = stride::ToSizeType(stride::ClusterType::School);
+	const auto household = stride::ToSizeType(stride::ClusterType::Household);
+	const auto community = stride::ToSizeType(stride::ClusterType::PrimaryCommunity);
+	EXPECT_EQ(stride::TransmissionKernel::MeanField, kernels[work]);
+	EXPECT_EQ(stride::TransmissionKernel::SkipSampling, small_cluster_kernels[work]);
+	EXPECT_EQ(stride::TransmissionKernel::MeanField, kernels[school]);
+	EXPECT_EQ(stride::TransmissionKernel::Pairwise, small_cluster_kernels[school]);
+	EXPECT_EQ(stride::TransmissionKernel::SkipSampling, kernels[household]);
+	EXPECT_EQ(stride::TransmissionKernel::SkipSampling, small_cluster_kernels[household]);
+	EXPECT_EQ(stride::TransmissionKernel::Pairwise, kernels[community]);
+	EXPECT_EQ(stride::TransmissionKernel::Pairwise, small_cluster_kernels[community]);
+
+	pt.put("run.transmission_kernel.work.<xmlattr>.fallback", "MeanField");
+	EXPECT_THROW(config.Parse(pt.get_child("run")), std::runtime_error);
+}
+
 TEST(ParseSimulationConfig, ExceptionOnInvalidFile)
 {
 	std::istringstream pop_file{"<a>123</a>"};
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <gtest/gtest.h>
+#include <core/ClusterType.h>
+#include <pop/Person.h>
+#include <pop/PersonStore.h>
+#include <pop/Population.h>
+
+using namespace stride;
+
+namespace Tests {
+
+TEST(PersonStore, EmplaceAndErase)
+{
+	PersonStore store;
+	const auto first = store.Emplace(7, 30.0, 1, 0, 2, 3, 4, disease::Fate{1, 2, 3, 4});
+	const auto second = store.Emplace(9, 8.0, 1, 5, 0, 3, 4, disease::Fate());
+	EXPECT_EQ(2U, store.GetSize());
+	EXPECT_EQ(first, store.Find(7));
+	EXPECT_EQ(second, store.Find(9));
+	EXPECT_EQ(PersonStore::g_no_index, store.Find(8));
+	EXPECT_EQ(30.0, store.GetAge(first));
+	EXPECT_EQ(5U, store.GetClusterId(second, ClusterType::School));
+	EXPECT_EQ(3U, store.GetHealth(first).GetEndInfectiousness());
+
+	store.Erase(first);
+	EXPECT_EQ(1U, store.GetSize());
+	EXPECT_FALSE(store.IsLive(first));
+	EXPECT_EQ(PersonStore::g_no_index, store.Find(7));
+	EXPECT_EQ(second, store.Find(9));
+
+	// The freed row is recycled; the other row is left untouched.
+	EXPECT_EQ(first, store.Emplace(11, 50.0, 2, 0, 0, 3, 4, disease::Fate()));
+	EXPECT_EQ(9U, store.GetId(second));
+	EXPECT_EQ(2U, store.GetRowCount());
+}
+
+TEST(PersonStore, SparseIds)
+{
+	// A single person with a large id does not make the store map all ids below it.
+	PersonStore store;
+	const PersonId large_id = 50000000U;
+	const auto large = store.Emplace(large_id, 30.0, 1, 0, 0, 1, 1, disease::Fate());
+	EXPECT_LT(store.GetMemoryUsage(), 64U * 1024U);
+	EXPECT_EQ(large, store.Find(large_id));
+	EXPECT_EQ(PersonStore::g_no_index, store.Find(large_id - 1));
+
+	// Ids that are in proportion to the number of persons are mapped directly.
+	for (PersonId id = 0; id < 1000; id++) {
+		store.Emplace(id, 30.0, 1, 0, 0, 1, 1, disease::Fate());
+	}
+	for (PersonId id = 0; id < 1000; id++) {
+		ASSERT_EQ(id, store.GetId(store.Find(id)));
+	}
+	EXPECT_EQ(large, store.Find(large_id));
+	store.Erase(large);
+	EXPECT_EQ(PersonStore::g_no_index, store.Find(large_id));
+	EXPECT_EQ(large, store.Emplace(large_id + 1, 30.0, 1, 0, 0, 1, 1, disease::Fate()));
+	EXPECT_EQ(large, store.Find(large_id + 1));
+}
+
+TEST(PersonStore, Presence)
+{
+	PersonStore store;
+	const auto child = store.Emplace(0, 10.0, 1, 1, 0, 1, 1, disease::Fate());
+	const auto adult = store.Emplace(1, 40.0, 1, 0, 1, 1, 1, disease::Fate());
+
+	store.UpdatePresence(false, true);
+	EXPECT_FALSE(store.IsInCluster(child, ClusterType::School));
+	EXPECT_TRUE(store.IsInCluster(child, ClusterType::PrimaryCommunity));
+	EXPECT_TRUE(store.IsInCluster(adult, ClusterType::Work));
+	EXPECT_FALSE(store.IsInCluster(adult, ClusterType::PrimaryCommunity));
+	EXPECT_TRUE(store.IsInCluster(adult, ClusterType::Household));
+}
+
+TEST(PersonStore, DayTypePresence)
+{
+	PersonStore store;
+	const auto child = store.Emplace(0, 10.0, 1, 1, 0, 1, 1, disease::Fate());
+	const auto adult = store.Emplace(1, 40.0, 1, 1, 1, 1, 1, disease::Fate());
+	const auto key = store.GetPresenceKey();
+
+	// Only the adult goes to school during school holidays, nobody in the weekend.
+	store.UpdatePresence(false, true);
+	EXPECT_NE(key, store.GetPresenceKey());
+	EXPECT_FALSE(store.IsInCluster(child, ClusterType::School));
+	EXPECT_TRUE(store.IsInCluster(adult, ClusterType::School));
+	store.UpdatePresence(true, true);
+	EXPECT_FALSE(store.IsInCluster(adult, ClusterType::School));
+	EXPECT_TRUE(store.IsInCluster(child, ClusterType::PrimaryCommunity));
+	EXPECT_TRUE(store.IsPresentToday(false, ClusterType::Household));
+}
+
+TEST(PersonStore, DetachedPerson)
+{
+	Population population;
+	population.emplace(3, 20.0, 1, 0, 1, 1, 1, disease::Fate{1, 1, 5, 5});
+	population.getPerson(3).StartInfection();
+
+	auto person = population.extract(3);
+	EXPECT_EQ(0U, population.size());
+	EXPECT_EQ(3U, person.GetId());
+	EXPECT_TRUE(person.GetHealth().IsInfected());
+
+	auto copy = person.WithId(4);
+	copy.StopInfection();
+	EXPECT_TRUE(person.GetHealth().IsInfected());
+	EXPECT_TRUE(copy.GetHealth().IsRecovered());
+
+	population.emplace(copy);
+	EXPECT_EQ(1U, population.get_infected_count());
+	EXPECT_EQ(4U, (*population.begin()).GetId());
+}
+
+TEST(PersonStore, AdvanceDay)
+{
+	// Fates with coinciding and far away transitions, some persons infected mid-way.
+	const std::vector<disease::Fate> fates{{1, 1, 3, 3}, {2, 4, 6, 5}, {3, 2, 40, 9}, {5, 1, 7, 12}};
+	PersonStore store;
+	std::vector<Health> expected;
+	for (unsigned int i = 0; i < 2 * fates.size(); i++) {
+		store.Emplace(i, 30.0, 1, 0, 0, 0, 0, fates[i % fates.size()]);
+		expected.emplace_back(fates[i % fates.size()]);
+	}
+
+	std::vector<PersonIndex> changes;
+	for (unsigned int day = 0; day < 50; day++) {
+		if (day == 0 || day == 4) {
+			const PersonIndex first = day == 0 ? 0 : fates.size();
+			for (PersonIndex i = first; i < first + fates.size(); i++) {
+				store.StartInfection(i);
+				expected[i].StartInfection();
+			}
+		}
+		changes.clear();
+		store.AdvanceDay(changes);
+		for (PersonIndex i = 0; i < expected.size(); i++) {
+			const bool was_infectious = expected[i].IsInfectious();
+			expected[i].Update();
+			const auto health = store.GetHealth(i);
+			EXPECT_EQ(expected[i].GetHealthStatus(), health.GetHealthStatus());
+			EXPECT_EQ(expected[i].GetDaysInfected(), health.GetDaysInfected());
+			const bool changed = std::find(changes.begin(), changes.end(), i) != changes.end();
+			EXPECT_EQ(was_infectious != expected[i].IsInfectious(), changed);
+		}
+	}
+}
+
+TEST(PersonStore, StatusCounts)
+{
+	Population population;
+	for (unsigned int i = 0; i < 100; i++) {
+		population.emplace(i, 30.0, 1, 0, 0, 0, 0, disease::Fate{1, 2, 3, 4});
+	}
+	auto& store = population.get_store();
+	for (PersonIndex i = 0; i < 10; i++) {
+		store.SetImmune(i);
+	}
+	for (PersonIndex i = 10; i < 30; i++) {
+		store.StartInfection(i);
+	}
+	std::vector<PersonIndex> changes;
+	store.AdvanceDay(changes);
+	EXPECT_EQ(20U, changes.size());
+	EXPECT_EQ(20U, store.GetStatusCount(HealthStatus::Infectious));
+
+	// Persons that leave and return are counted with their current health.
+	auto person = population.extract(15);
+	auto copy = person.WithId(200);
+	copy.StopInfection();
+	population.emplace(copy);
+	population.extract(0);
+	EXPECT_EQ(99U, population.size());
+
+	std::array<std::size_t, NumOfHealthStatuses()> expected{};
+	for (const auto& p : population) {
+		expected[ToSizeType(p.GetHealth().GetHealthStatus())]++;
+	}
+	for (std::size_t status = 0; status < NumOfHealthStatuses(); status++) {
+		EXPECT_EQ(expected[status], store.GetStatusCount(static_cast<HealthStatus>(status)));
+	}
+	EXPECT_EQ(20U, population.get_infected_count());
+	EXPECT_EQ(0U, population.get_adopted_count());
+}
+
+TEST(PersonStore, ShardedCounters)
+{
+	// The counts are carried over when a growing store spreads its counters over shards.
+	PersonStore store;
+	for (unsigned int i = 0; i < 3000; i++) {
+		store.Emplace(i, 30.0, 1, 0, 0, 0, 0, disease::Fate{1, 2, 3, 4});
+		if (i % 3 == 0) {
+			store.SetImmune(i);
+		}
+	}
+	EXPECT_EQ(1000U, store.GetStatusCount(HealthStatus::Immune));
+	EXPECT_EQ(2000U, store.GetStatusCount(HealthStatus::Susceptible));
+	store.Erase(0);
+	store.StartInfection(1);
+	EXPECT_EQ(999U, store.GetStatusCount(HealthStatus::Immune));
+	EXPECT_EQ(1U, store.GetInfectedCount());
+}
+
+TEST(PersonStore, FirstTouch)
+{
+	PersonStore store;
+	const unsigned int count = 10000U;
+	for (unsigned int i = 0; i < count; i++) {
+		store.Emplace(i, i % 90, i, 0, i + 1, i + 2, i + 3, disease::Fate{1, 2, 3, 4});
+	}
+	store.Erase(store.Find(5));
+	store.StartInfection(store.Find(6));
+
+	store.FirstTouch(4);
+	EXPECT_EQ(count - 1, store.GetSize());
+	EXPECT_EQ(PersonStore::g_no_index, store.Find(5));
+	EXPECT_EQ(HealthStatus::Exposed, store.GetHealthStatus(store.Find(6)));
+	for (unsigned int i = 7; i < count; i++) {
+		const auto index = store.Find(i);
+		ASSERT_EQ(i, store.GetId(index));
+		ASSERT_EQ(i % 90, store.GetAge(index));
+		ASSERT_EQ(i + 3, store.GetClusterId(index, ClusterType::SecondaryCommunity));
+		ASSERT_EQ(3U, store.GetHealth(index).GetEndInfectiousness());
+	}
+	// All pages are on the node of the thread that wrote them, if the machine has nodes at all.
+	EXPECT_EQ(0U, store.CountRemotePages(1));
+}
+
+TEST(PersonStore, MemoryUsage)
+{
+	PersonStore store;
+	const unsigned int count = 100000U;
+	store.Reserve(count);
+	for (unsigned int i = 0; i < count; i++) {
+		store.Emplace(i, 30.0, i, 0, i, i, i, disease::Fate());
+	}
+	// A person used to cost a map node, a control block and a heap allocated
+	// PersonData: roughly 160 bytes.
+	EXPECT_LT(3.0 * store.GetMemoryUsage() / count, 160.0);
+}
+
+} // Tests
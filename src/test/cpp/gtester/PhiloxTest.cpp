@@ -0,0 +1,54 @@
+#include <vector>
+#include <gtest/gtest.h>
+#include <util/Philox.h>
+
+// The gtester_avx2 executable exists to test the vectorized generator.
+#if defined(STRIDE_TEST_AVX2) && !defined(__AVX2__)
+#error "PhiloxTest.cpp is compiled without AVX2 for gtester_avx2."
+#endif
+
+using namespace stride::util;
+
+namespace Tests {
+
+TEST(Philox, KnownAnswers)
+{
+	// Known answers of the reference implementation of Philox4x32-10 (Random123).
+	const Philox4x32::Counter expected_zero{{0x6627e8d5U, 0xe169c58dU, 0xbc57ac4cU, 0x9b00dbd8U}};
+	EXPECT_EQ(expected_zero, Philox4x32::Generate({{0U, 0U, 0U, 0U}}, {{0U, 0U}}));
+
+	const Philox4x32::Counter expected_ones{{0x408f276dU, 0x41c83b0eU, 0xa20bc7c6U, 0x6d5451fdU}};
+	EXPECT_EQ(expected_ones, Philox4x32::Generate({{~0U, ~0U, ~0U, ~0U}}, {{~0U, ~0U}}));
+
+	const Philox4x32::Counter expected_pi{{0xd16cfe09U, 0x94fdccebU, 0x5001e420U, 0x24126ea1U}};
+	EXPECT_EQ(
+	    expected_pi, Philox4x32::Generate(
+			     {{0x243f6a88U, 0x85a308d3U, 0x13198a2eU, 0x03707344U}}, {{0xa4093822U, 0x299f31d0U}}));
+
+	EXPECT_EQ(0.0, Philox4x32::ToDouble(0U));
+	EXPECT_EQ(0.5, Philox4x32::ToDouble(0x80000000U));
+	EXPECT_EQ(1.0 - 1.0 / 4294967296.0, Philox4x32::ToDouble(~0U));
+}
+
+TEST(Philox, GenerateDoubles)
+{
+	// Bulk generation, vectorized where AVX2 is available, gives the doubles of the scalar generator,
+	// also for a number of blocks that is not a multiple of the vector width and when the counter wraps.
+	const Philox4x32::Key key{{0x01234567U, 0x89abcdefU}};
+	for (const std::uint32_t first : {0U, 0xfffffff9U}) {
+		const Philox4x32::Counter counter{{first, 7U, 11U, 13U}};
+		const std::size_t num_blocks = 13U;
+		std::vector<double> actual(4 * num_blocks);
+		Philox4x32::GenerateDoubles(counter, key, num_blocks, actual.data());
+		for (std::size_t block = 0; block < num_blocks; block++) {
+			auto block_counter = counter;
+			block_counter[0] += static_cast<std::uint32_t>(block);
+			const auto words = Philox4x32::Generate(block_counter, key);
+			for (std::size_t i = 0; i < words.size(); i++) {
+				ASSERT_EQ(Philox4x32::ToDouble(words[i]), actual[4 * block + i]) << block << " " << i;
+			}
+		}
+	}
+}
+
+} // Tests
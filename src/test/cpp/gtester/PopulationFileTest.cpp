@@ -0,0 +1,53 @@
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "pop/PopulationFile.h"
+
+using namespace stride;
+
+namespace Tests {
+
+TEST(PopulationFile, ParseCsv)
+{
+	const std::string contents = "\"age\",\"household_id\",\"school_id\",\"work_id\",\"primary_community\","
+				     "\"secondary_community\",\"risk_averseness\"\n"
+				     "71,1,0,0,10,14\n"
+				     "\r\n"
+				     "8,2,3,0,11,15,0.25\r\n"
+				     "40.5,2,0,7,11,15,-1.5e-1\n"
+				     "33,4,0,0,12,16,";
+	const auto records = PopulationFile::ParseCsv(contents.data(), contents.size(), 1U);
+	ASSERT_EQ(records.size(), 4U);
+	EXPECT_EQ(records[0].age, 71U);
+	EXPECT_EQ(records[0].secondary_community_id, 14U);
+	EXPECT_EQ(records[0].risk_averseness, 0.0);
+	EXPECT_EQ(records[1].school_id, 3U);
+	EXPECT_EQ(records[1].risk_averseness, 0.25);
+	EXPECT_EQ(records[2].age, 40U);
+	EXPECT_EQ(records[2].work_id, 7U);
+	EXPECT_EQ(records[2].risk_averseness, -0.15);
+	EXPECT_EQ(records[3].primary_community_id, 12U);
+	EXPECT_EQ(records[3].risk_averseness, 0.0);
+}
+
+TEST(PopulationFile, ParseCsvAcrossBlocks)
+{
+	// Several blocks worth of lines, so that lines straddle the block boundaries.
+	std::string contents = "age,household_id,school_id,work_id,primary_community,secondary_community\n";
+	const unsigned int num_lines = 200000U;
+	for (unsigned int i = 0; i < num_lines; i++) {
+		contents += std::to_string(i % 90) + "," + std::to_string(i) + ",0," + std::to_string(i / 3) + ",1,2\n";
+	}
+	const auto serial = PopulationFile::ParseCsv(contents.data(), contents.size(), 1U);
+	const auto parallel = PopulationFile::ParseCsv(contents.data(), contents.size(), 4U);
+	ASSERT_EQ(serial.size(), num_lines);
+	ASSERT_EQ(parallel.size(), num_lines);
+	for (unsigned int i = 0; i < num_lines; i++) {
+		ASSERT_EQ(serial[i].age, i % 90);
+		ASSERT_EQ(serial[i].household_id, i);
+		ASSERT_EQ(serial[i].work_id, i / 3);
+		ASSERT_EQ(parallel[i].household_id, i);
+	}
+}
+
+} // Tests
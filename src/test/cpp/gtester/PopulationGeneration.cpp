@@ -35,6 +35,38 @@ TEST(PopulationGeneration, GeneratedPopulationFitsModel)
 	ASSERT_TRUE(generator->FitsModel(population));
 }
 
+TEST(PopulationGeneration, GeneratedPopulationDoesNotDependOnThreads)
+{
+	ptree pt_config;
+	InstallDirs::ReadXmlFile("../config/run_test_popgen.xml", InstallDirs::GetCurrentDir(), pt_config);
+	stride::SingleSimulationConfig config;
+	config.Parse(pt_config.get_child("run"));
+	ptree pt_disease;
+	InstallDirs::ReadXmlFile(config.common_config->disease_config_file_name, InstallDirs::GetDataDir(), pt_disease);
+	const auto disease = disease::Disease::Parse(pt_disease);
+
+	stride::util::Random serial_rng(1);
+	auto serial = population::Generator::FromConfig(config, *disease, serial_rng)->Generate(1U);
+	stride::util::Random parallel_rng(1);
+	auto parallel = population::Generator::FromConfig(config, *disease, parallel_rng)->Generate(4U);
+
+	ASSERT_EQ(serial.size(), parallel.size());
+	auto it = parallel.begin();
+	for (const auto& person : serial) {
+		const auto other = *it;
+		ASSERT_EQ(person.GetId(), other.GetId());
+		ASSERT_EQ(person.GetAge(), other.GetAge());
+		for (auto type : {ClusterType::Household, ClusterType::School, ClusterType::Work,
+				  ClusterType::PrimaryCommunity, ClusterType::SecondaryCommunity}) {
+			ASSERT_EQ(person.GetClusterId(type), other.GetClusterId(type));
+		}
+		ASSERT_EQ(person.GetHealth().GetEndInfectiousness(), other.GetHealth().GetEndInfectiousness());
+		++it;
+	}
+	// The generator leaves both random number generators in the same state.
+	ASSERT_EQ(serial_rng.NextDouble(), parallel_rng.NextDouble());
+}
+
 TEST(PopulationGeneration, GeneratedPopulationIsInfectious)
 {
 	auto log = spdlog::stderr_logger_st("test_popgen");